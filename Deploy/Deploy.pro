@@ -13,6 +13,7 @@
 #-------------------------------------------------
 
 QT       -= gui
+QT       += concurrent
 CONFIG += c++17
 TARGET = Deploy
 TEMPLATE = lib
@@ -47,6 +48,7 @@ include('$$PWD/../pe/pe-parser-library/pe-parser-library.pri')
 SOURCES += \
     Distributions/defaultdistro.cpp \
     Distributions/templateinfo.cpp \
+    dependencygraph.cpp \
     dependencymap.cpp \
     deployconfig.cpp \
     distromodule.cpp \
@@ -54,30 +56,41 @@ SOURCES += \
     configparser.cpp \
     deploy.cpp \
     deploycore.cpp \
+    deploymanifest.cpp \
     envirement.cpp \
     extra.cpp \
     extracter.cpp \
+    filecopier.cpp \
     filemanager.cpp \
     Distributions/idistribution.cpp \
     ignorerule.cpp \
     metafilemanager.cpp \
     packing.cpp \
     pathutils.cpp \
+    pathmatcher.cpp \
     pe.cpp \
     igetlibinfo.cpp \
+    ldcache.cpp \
     dependenciesscanner.cpp \
-    ../qtTools/src/shared/winutils/elfreader.cpp \
+    mappedelf.cpp \
+    mappedpe.cpp \
     elf.cpp \
+    elfstrip.cpp \
+    envlibindex.cpp \
     pluginsparser.cpp \
     Distributions/qif.cpp \
     qml.cpp \
+    qmlimportparser.cpp \
+    qmlmoduleindex.cpp \
     libinfo.cpp \
     qtdir.cpp \
+    scancache.cpp \
     targetinfo.cpp
 
 HEADERS += \
     Distributions/defaultdistro.h \
     Distributions/templateinfo.h \
+    dependencygraph.h \
     dependencymap.h \
     deployconfig.h \
     distromodule.h \
@@ -86,25 +99,35 @@ HEADERS += \
     deploy.h \
     deploy_global.h \
     deploycore.h \
+    deploymanifest.h \
     envirement.h \
     extra.h \
     extracter.h \
+    filecopier.h \
     filemanager.h \
     Distributions/idistribution.h \
     ignorerule.h \
     metafilemanager.h \
     packing.h \
     pathutils.h \
+    pathmatcher.h \
     pe.h \
     igetlibinfo.h \
+    ldcache.h \
     dependenciesscanner.h \
-    ../qtTools/src/shared/winutils/elfreader.h \
+    mappedelf.h \
+    mappedpe.h \
     elf.h \
+    elfstrip.h \
+    envlibindex.h \
     pluginsparser.h \
     Distributions/qif.h \
     qml.h \
+    qmlimportparser.h \
+    qmlmoduleindex.h \
     libinfo.h \
     qtdir.h \
+    scancache.h \
     targetinfo.h
 
 STATECHARTS +=
@@ -108,7 +108,7 @@ bool iDistribution::moveData(const QString &from,
 }
 
 bool iDistribution::copyFile(const QString &from, const QString &to) const {
-    return _fileManager->copyFile(from, to);
+    return _fileManager->copyFile(from, to) && _fileManager->waitForCopies();
 }
 
 QMap<int ,QPair<QString, const DistroModule*>>
@@ -725,8 +725,12 @@ void ConfigParser::initIgnoreList()
 
     if (!QuasarAppUtils::Params::isEndable("deploySystem-with-libc")) {
 
-        envUnix.addEnv(Envirement::recursiveInvairement("/lib", 3));
-        envUnix.addEnv(Envirement::recursiveInvairement("/usr/lib", 3));
+        if (_config.ldCache.isValid()) {
+            envUnix.addEnv(_config.ldCache.dirs());
+        } else {
+            envUnix.addEnv(Envirement::recursiveInvairement("/lib", 3));
+            envUnix.addEnv(Envirement::recursiveInvairement("/usr/lib", 3));
+        }
         ruleUnix.prority = SystemLib;
         ruleUnix.platform = Unix;
         ruleUnix.enfirement = envUnix;
@@ -1118,8 +1122,10 @@ void ConfigParser::initEnvirement() {
     QStringList dirs;
 #ifdef Q_OS_LINUX
 
-    dirs.append(getDirsRecursive("/lib", 5));
-    dirs.append(getDirsRecursive("/usr/lib", 5));
+    if (!initLdCache()) {
+        dirs.append(getDirsRecursive("/lib", 5));
+        dirs.append(getDirsRecursive("/usr/lib", 5));
+    }
 #else
     auto winPath = findWindowsPath(path);
     dirs.append(getDirsRecursive(winPath + "/System32", 2));
@@ -1129,11 +1135,37 @@ void ConfigParser::initEnvirement() {
 
     _config.envirement.addEnv(dirs);
 
-    if (_config.envirement.size() < 2) {
+    if (_config.envirement.size() < 2 && !_config.ldCache.isValid()) {
         qWarning() << "system environment is empty";
     }
 }
 
+bool ConfigParser::initLdCache() {
+    if (QuasarAppUtils::Params::isEndable("noLdCache")) {
+        return false;
+    }
+
+    if (!_config.ldCache.load()) {
+        QuasarAppUtils::Params::verboseLog("Failed to read the " + LdCache::defaultFile() +
+                                           ", system libraries will be searched in the /lib and /usr/lib dirs",
+                                           QuasarAppUtils::Warning);
+        return false;
+    }
+
+    for (const auto &dir: _config.ldCache.dirs()) {
+        if (_config.envirement.isIgnored(dir)) {
+            _config.ldCache.removeDir(dir);
+        }
+    }
+
+    QuasarAppUtils::Params::verboseLog(QString("Found %0 system libraries in the %1").
+                                       arg(_config.ldCache.size()).
+                                       arg(LdCache::defaultFile()),
+                                       QuasarAppUtils::Info);
+
+    return true;
+}
+
 QStringList ConfigParser::getDirsRecursive(const QString &path, int maxDepch, int depch) {
     return getSetDirsRecursive(path, maxDepch, depch).values();
 }
@@ -1186,6 +1218,11 @@ bool ConfigParser::smartMoveTargets() {
 
     _config.targetsEdit() = temp;
 
+    // the targets will be scanned in target dir.
+    if (!_fileManager->waitForCopies()) {
+        result = false;
+    }
+
     return result;
 }
 
@@ -72,6 +72,12 @@ private:
 
     void initEnvirement();
 
+    /**
+     * @brief initLdCache - load system libraries from the /etc/ld.so.cache.
+     * @return true if the cache is loaded and the system dirs should not be scanned.
+     */
+    bool initLdCache();
+
     QStringList getDirsRecursive(const QString &path, int maxDepch = -1, int depch = 0);
     QSet<QString> getSetDirsRecursive(const QString &path, int maxDepch = -1, int depch = 0);
 
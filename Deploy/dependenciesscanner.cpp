@@ -12,14 +12,48 @@
 #include <QList>
 #include <QDir>
 #include <QDebug>
+#include <QCryptographicHash>
+#include <QtConcurrent>
+#include <algorithm>
 #include "pathutils.h"
 
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+const QVector<LibInfo> &ScanResult::libs() const {
+    return _libs;
+}
+
+QVector<int> ScanResult::closure(const QString &root) const {
+    return _closures.value(root);
+}
+
+QSet<LibInfo> ScanResult::closureSet(const QString &root) const {
+    QSet<LibInfo> result;
+
+    for (int index: _closures.value(root)) {
+        result.insert(_libs[index]);
+    }
+
+    return result;
+}
+
+QStringList ScanResult::roots() const {
+    return _roots;
+}
+
 DependenciesScanner::DependenciesScanner() {
 
 }
 
 void DependenciesScanner::clearScaned() {
-    _scanedLibs.clear();
+    _graph.clear();
+    _rpathLibs.clear();
+
+    QWriteLocker locker(&_parsedLibsLock);
+    _parsedLibs.clear();
+    _parsedIds.clear();
 }
 
 PrivateScaner DependenciesScanner::getScaner(const QString &lib) const {
@@ -38,121 +72,496 @@ PrivateScaner DependenciesScanner::getScaner(const QString &lib) const {
     return PrivateScaner::UNKNOWN;
 }
 
-QMultiMap<LibPriority, LibInfo> DependenciesScanner::getLibsFromEnvirement(
-        const QString &libName) const {
+static bool isDeployable(LibPriority priority) {
+    return priority < SystemLib || QuasarAppUtils::Params::isEndable("deploySystem");
+}
+
+QStringList DependenciesScanner::getCandidatesFromEnvirement(const QString &libName,
+                                                              Platform platform) const {
+    auto upperName = libName.toUpper();
+    auto values = _envLibs.find(upperName);
 
-    auto values = _EnvLibs.values(libName.toUpper());
-    QMultiMap<LibPriority, LibInfo> res;
+    if (DeployCore::_config && DeployCore::_config->ldCache.isValid()) {
+        values += DeployCore::_config->ldCache.find(upperName, platform);
+        values.removeDuplicates();
+
+        // the libraries without soname and the libraries of dirs that are not in the ld.so.conf.
+        if (values.isEmpty()) {
+            values = getCandidatesFromSystemDirs(upperName);
+        }
+    }
+    QStringList res;
 
     for (const auto & lib : values) {
-        LibInfo info;
+        if (!isDeployable(DeployCore::getLibPriority(lib))) {
+            continue;
+        }
+
+        res.push_back(lib);
+    }
+
+    return res;
+}
+
+static void systemDirsRecursive(const QString &path, int maxDepth, int depth, QStringList &result) {
+    result.push_back(path);
+
+    if (depth >= maxDepth) {
+        return;
+    }
+
+    auto list = QDir(path).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+
+    for (const auto &dir: list) {
+        systemDirsRecursive(dir.absoluteFilePath(), maxDepth, depth + 1, result);
+    }
+}
+
+QStringList DependenciesScanner::getCandidatesFromSystemDirs(const QString &upperName) const {
+    QMutexLocker locker(&_systemLibsLock);
+
+    if (!_systemLibsReady) {
+        QStringList dirs;
+        systemDirsRecursive("/lib", 5, 0, dirs);
+        systemDirsRecursive("/usr/lib", 5, 0, dirs);
+
+        _systemLibs.build(dirs, QStringList() << "*.SO*" << "*.so*");
+        _systemLibsReady = true;
+    }
+
+    return _systemLibs.find(upperName);
+}
+
+QHash<QString, QString> DependenciesScanner::getLibsOfDir(const QString &dir) {
+    auto it = _rpathLibs.constFind(dir);
+    if (it != _rpathLibs.constEnd()) {
+        return *it;
+    }
+
+    QHash<QString, QString> libs;
+    auto list = QDir(dir).entryInfoList(QStringList() << "*.SO*" << "*.so*",
+                                        QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden);
+
+    for (const auto &info: list) {
+        libs.insert(info.fileName().toUpper(), info.absoluteFilePath());
+    }
+
+    _rpathLibs.insert(dir, libs);
+    return libs;
+}
+
+QStringList DependenciesScanner::getCandidatesFromRpath(const LibInfo &lib,
+                                                        const QString &libName,
+                                                        bool *preferred) {
+    QStringList res;
+
+    if (preferred) {
+        *preferred = false;
+    }
+
+    if (lib.getRpath().isEmpty()) {
+        return res;
+    }
+
+    const auto dirs = ELF::getSearchPaths(lib);
+    for (const auto &dir: dirs) {
+        auto path = getLibsOfDir(dir).value(libName.toUpper());
+
+        if (path.isEmpty()) {
+            continue;
+        }
+
+        auto priority = DeployCore::getLibPriority(path);
+        if (!isDeployable(priority)) {
+            continue;
+        }
+
+        if (preferred && priority <= ExtraLib) {
+            *preferred = true;
+        }
+
+        res.push_back(path);
+    }
+
+    return res;
+}
+
+QStringList DependenciesScanner::getCandidates(const LibInfo &lib, const QString &libName) {
+    bool preferred = false;
+    auto res = getCandidatesFromRpath(lib, libName, &preferred);
+
+    if (preferred) {
+        return res;
+    }
+
+    res += getCandidatesFromEnvirement(libName, lib.getPlatform());
+    res.removeDuplicates();
+
+    return res;
+}
+
+QStringList DependenciesScanner::sortByPriority(const QStringList &candidates) const {
+    QVector<QPair<LibPriority, QString>> sorted;
+    sorted.reserve(candidates.size());
+
+    for (const auto &candidate: candidates) {
+        sorted.push_back({DeployCore::getLibPriority(candidate), candidate});
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(), [](const QPair<LibPriority, QString> &left,
+                                                      const QPair<LibPriority, QString> &right) {
+        return left.first < right.first;
+    });
+
+    QStringList res;
+    res.reserve(sorted.size());
+
+    for (const auto &item: sorted) {
+        res.push_back(item.second);
+    }
+
+    return res;
+}
+
+Platform DependenciesScanner::probePlatform(const QString &file) const {
+    {
+        QReadLocker locker(&_parsedLibsLock);
+        auto it = _parsedLibs.constFind(file);
+        if (it != _parsedLibs.constEnd()) {
+            return it->getPlatform();
+        }
+    }
+
+    switch (getScaner(file)) {
+    case PrivateScaner::PE: return _peScaner.probePlatform(file);
+    case PrivateScaner::ELF: return _elfScaner.probePlatform(file);
+    default: return UnknownPlatform;
+    }
+}
+
+bool DependenciesScanner::isAcceptable(const QString &candidate, Platform platform) const {
+    LibInfo info;
+    info.setPlatform(probePlatform(candidate));
 
-        auto priority = (DeployCore::getLibPriority(lib));
+    if (info.getPlatform() != platform) {
+        return false;
+    }
 
-        if ((priority >= SystemLib) && !QuasarAppUtils::Params::isEndable("deploySystem")) {
+    if (!DeployCore::_config) {
+        return true;
+    }
+
+    QFileInfo fileInfo(candidate);
+    info.setName(fileInfo.fileName());
+    info.setPath(fileInfo.absolutePath());
+    info.setPriority(DeployCore::getLibPriority(candidate));
+
+    return !DeployCore::_config->ignoreList.isIgnore(info);
+}
+
+bool DependenciesScanner::selectCandidate(const QStringList &candidates, const QString &libName,
+                                          Platform platform, LibInfo &result) {
+
+    for (const auto & lib : candidates) {
+        if (!isAcceptable(lib, platform)) {
             continue;
         }
 
-        if (!fillLibInfo(info, lib)) {
+        if (!fillLibInfo(result, lib)) {
             QuasarAppUtils::Params::verboseLog(
                         "error extract lib info from " + lib + "(" + libName + ")",
                         QuasarAppUtils::VerboseLvl::Warning);
             continue;
         }
 
-        info.setPriority(priority);
+        result.setPriority(DeployCore::getLibPriority(lib));
+        return true;
+    }
 
-        if (!DeployCore::_config->ignoreList.isIgnore(info)) {
-            res.insertMulti(info.getPriority(), info);
+    return false;
+}
+
+bool DependenciesScanner::getLibFromEnvirement(const LibInfo &lib, const QString &libName,
+                                               LibInfo &result) {
+
+    // the rpath of correctly linked binary points to the qt or extra libs,
+    // so the environment is not needed if the rpath gives a library of the same platform.
+    bool preferred = false;
+    auto rpathCandidates = sortByPriority(getCandidatesFromRpath(lib, libName, &preferred));
+
+    if (preferred && selectCandidate(rpathCandidates, libName, lib.getPlatform(), result) &&
+            result.getPriority() <= ExtraLib) {
+        return true;
+    }
+
+    auto candidates = rpathCandidates + getCandidatesFromEnvirement(libName, lib.getPlatform());
+    candidates.removeDuplicates();
+
+    return selectCandidate(sortByPriority(candidates), libName, lib.getPlatform(), result);
+}
+
+bool DependenciesScanner::fillLibInfo(LibInfo &info, const QString &file) {
+
+    {
+        QReadLocker locker(&_parsedLibsLock);
+        auto it = _parsedLibs.constFind(file);
+        if (it != _parsedLibs.constEnd()) {
+            info = *it;
+            return info.isValid();
         }
+    }
 
+    // the other name of the same file (libA.so.5 -> libA.so.5.14.2) is not parsed again.
+    auto id = fileId(file);
+
+    if (id.size()) {
+        bool found = false;
+
+        {
+            QReadLocker locker(&_parsedLibsLock);
+            auto it = _parsedIds.constFind(id);
+            if (it != _parsedIds.constEnd()) {
+                info = *it;
+                found = true;
+            }
+        }
+
+        if (found) {
+            if (info.isValid()) {
+                QFileInfo fileInfo(file);
+                info.setName(fileInfo.fileName());
+                info.setPath(fileInfo.absolutePath());
+            }
+
+            QWriteLocker locker(&_parsedLibsLock);
+            _parsedLibs.insert(file, info);
+
+            return info.isValid();
+        }
     }
 
-    return res;
+    bool result = parseLibInfo(info, file);
+
+    if (!result) {
+        info.clear();
+    }
+
+    QWriteLocker locker(&_parsedLibsLock);
+    _parsedLibs.insert(file, info);
+
+    if (id.size()) {
+        _parsedIds.insert(id, info);
+    }
+
+    return result;
 }
 
-bool DependenciesScanner::fillLibInfo(LibInfo &info, const QString &file) const {
+QByteArray DependenciesScanner::fileId(const QString &file) {
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if (::stat(QFile::encodeName(file).constData(), &st) != 0) {
+        return "";
+    }
+
+    return QByteArray::number(static_cast<qulonglong>(st.st_dev)) + ":" +
+            QByteArray::number(static_cast<qulonglong>(st.st_ino));
+#else
+    return QFileInfo(file).canonicalFilePath().toUtf8();
+#endif
+}
+
+bool DependenciesScanner::parseLibInfo(LibInfo &info, const QString &file) {
 
     info.clear();
+
+    if (_cache.find(file, info)) {
+        return true;
+    }
+
     auto scaner = getScaner(file);
+    bool result = false;
 
     switch (scaner) {
     case PrivateScaner::PE: {
-        return _peScaner.getLibInfo(file, info);
+        result = _peScaner.getLibInfo(file, info);
+        break;
     }
     case PrivateScaner::ELF:
-        return _elfScaner.getLibInfo(file, info);
+        result = _elfScaner.getLibInfo(file, info);
+        break;
 
     default: return false;
     }
+
+    if (result) {
+        _cache.insert(file, info);
+    }
+
+    return result;
 }
 
-void DependenciesScanner::recursiveDep(LibInfo &lib, QSet<LibInfo> &res, QSet<QString>& libStack) {
-    QuasarAppUtils::Params::verboseLog("get recursive dependencies of " + lib.fullPath(),
-                                       QuasarAppUtils::Info);
+bool DependenciesScanner::loadClosure(int id) {
+    ScanCacheClosure closure;
 
-    if (_scanedLibs.contains(lib.fullPath())) {
-        auto scanedLib = _scanedLibs.value(lib.fullPath());
+    if (!_cache.findClosure(_graph.info(id).fullPath(), closure)) {
+        return false;
+    }
 
-        if (!scanedLib.isValid()) {
-            qCritical() << "no valid lib in scaned libs list!";
-            return;
-        }
+    QVector<int> ids;
+    ids.reserve(closure.libs.size());
 
-        res.unite(scanedLib.allDep);
+    for (const auto &path: closure.libs) {
+        int dep = _graph.find(path);
 
-        return;
+        if (dep < 0) {
+            LibInfo info;
+            if (!fillLibInfo(info, path)) {
+                return false;
+            }
+
+            info.setPriority(DeployCore::getLibPriority(path));
+            dep = _graph.addNode(info);
+        }
+
+        ids.push_back(dep);
     }
 
-    if (libStack.contains(lib.fullPath())) {
-        QuasarAppUtils::Params::verboseLog("A recursive dependency was found in library " + lib.fullPath(),
-                                           QuasarAppUtils::Warning);
-        return;
+    _graph.setClosure(id, ids, closure.winApi);
+
+    return true;
+}
+
+QByteArray DependenciesScanner::scanContext() const {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(_envLibs.fingerprint());
+
+    hash.addData(QByteArray::number(QuasarAppUtils::Params::isEndable("deploySystem")));
+
+    auto cnf = DeployCore::_config;
+    if (cnf) {
+        hash.addData(cnf->ldCache.fingerprint());
+        hash.addData(cnf->qtDir.getLibs().toUtf8());
+        hash.addData(cnf->qtDir.getBins().toUtf8());
+        hash.addData(cnf->qtDir.getLibexecs().toUtf8());
+        hash.addData(cnf->qtDir.getPlugins().toUtf8());
+        hash.addData(cnf->qtDir.getQmls().toUtf8());
+
+        auto extraPaths = cnf->extraPaths.getExtraPaths().values();
+        extraPaths.sort();
+        hash.addData(extraPaths.join(DeployCore::getEnvSeparator()).toUtf8());
+
+        // the masks decide the ExtraLib priority of libraries, so they change the resolved closures.
+        auto extraPathsMasks = cnf->extraPaths.getExtraPathsMasks().values();
+        extraPathsMasks.sort();
+        hash.addData(extraPathsMasks.join(DeployCore::getEnvSeparator()).toUtf8());
+
+        auto extraNamesMasks = cnf->extraPaths.getExtraNamesMasks().values();
+        extraNamesMasks.sort();
+        hash.addData(extraNamesMasks.join(DeployCore::getEnvSeparator()).toUtf8());
+
+        hash.addData(cnf->ignoreList.fingerprint().toUtf8());
     }
 
-    libStack.insert(lib.fullPath());
+    return hash.result();
+}
 
-    for (auto i : lib.dependncies) {
+void DependenciesScanner::prefetch(const QList<LibInfo> &libs) {
+    QSet<QString> requested;
+    QList<LibInfo> parents = libs;
 
-        auto libs = getLibsFromEnvirement(i);
+    while (parents.size()) {
+        QStringList files;
 
-        if (!libs.size()) {
-            QuasarAppUtils::Params::verboseLog("lib for dependese " + i + " not findet!!",
-                                               QuasarAppUtils::Warning);
-            continue;
+        for (const auto &parent: parents) {
+            for (const auto &name: parent.getDependncies()) {
+                // only the first acceptable candidate will be used, so only it is parsed.
+                for (const auto &candidate: sortByPriority(getCandidates(parent, name))) {
+                    if (!isAcceptable(candidate, parent.getPlatform())) {
+                        continue;
+                    }
+
+                    if (!requested.contains(candidate)) {
+                        requested.insert(candidate);
+
+                        QReadLocker locker(&_parsedLibsLock);
+                        if (!_parsedLibs.contains(candidate)) {
+                            files.push_back(candidate);
+                        }
+                    }
+
+                    break;
+                }
+            }
         }
 
-        auto dep = libs.begin();
+        std::function<LibInfo(const QString &)> parse = [this](const QString &file) {
+            LibInfo info;
+            fillLibInfo(info, file);
+            return info;
+        };
 
-        while (dep != libs.end() &&
-               dep.value().platform != lib.platform) dep++;
+        auto parsed = QtConcurrent::blockingMapped<QList<LibInfo>>(files, parse);
 
-        if (dep != libs.end() && !res.contains(*dep)) {
-            res.insert(*dep);
+        parents.clear();
+        for (const auto &info: parsed) {
+            if (info.isValid()) {
+                parents.push_back(info);
+            }
+        }
+    }
+}
 
-            LibInfo scanedLib = _scanedLibs.value(dep->fullPath());
+void DependenciesScanner::resolve(int root) {
+    QVector<int> queue = {root};
+    QVector<int> resolved;
 
-            if (!scanedLib.isValid()) {
-                QSet<LibInfo> listDep =  {};
+    while (queue.size()) {
+        int id = queue.takeLast();
 
-                if (!lib.name.compare(dep.value().name, ONLY_WIN_CASE_INSENSIATIVE))
-                    continue;
+        if (_graph.isResolved(id) || loadClosure(id)) {
+            continue;
+        }
 
-                recursiveDep(*dep, listDep, libStack);
+        // copy, because the adding of nodes can move the node info.
+        const LibInfo lib = _graph.info(id);
 
-                dep->allDep = listDep;
-                lib.setWinApi(lib.getWinApi() | dep->getWinApi());
-                _scanedLibs.insert(dep->fullPath(), *dep);
+        QuasarAppUtils::Params::verboseLog("get recursive dependencies of " + lib.fullPath(),
+                                           QuasarAppUtils::Info);
 
-                res.unite(listDep);
-            } else {
-                lib.setWinApi(lib.getWinApi() | scanedLib.getWinApi());
-                res.unite(scanedLib.allDep);
+        QVector<int> edges;
+
+        for (const auto &name : lib.getDependncies()) {
+            LibInfo dep;
+
+            if (!getLibFromEnvirement(lib, name, dep)) {
+                QuasarAppUtils::Params::verboseLog("lib for dependese " + name + " not findet!!",
+                                                   QuasarAppUtils::Warning);
+                continue;
+            }
+
+            int depId = _graph.addNode(dep);
+
+            if (depId != id) {
+                edges.push_back(depId);
+                queue.push_back(depId);
             }
         }
+
+        _graph.setEdges(id, edges);
+        resolved.push_back(id);
     }
 
-    libStack.remove(lib.fullPath());
+    for (int id : resolved) {
+        ScanCacheClosure closure;
+        closure.winApi = _graph.closureWinApi(id);
+
+        for (int dep : _graph.closure(id)) {
+            closure.libs.push_back(_graph.info(dep).fullPath());
+        }
+
+        _cache.insertClosure(_graph.info(id).fullPath(), closure);
+    }
 }
 
 void DependenciesScanner::addToWinAPI(const QString &lib, QHash<WinAPI, QSet<QString>>& res) {
@@ -171,33 +580,35 @@ void DependenciesScanner::addToWinAPI(const QString &lib, QHash<WinAPI, QSet<QSt
 }
 
 void DependenciesScanner::setEnvironment(const QStringList &env) {
-    QDir dir;
     QHash<WinAPI, QSet<QString>> winAPI;
 
 #ifdef Q_OS_WIN
     winAPI[WinAPI::Crt] += "UCRTBASE.DLL";
 #endif
 
-    for (auto i : env) {
+    // each environment has own index file, so the deploys from different environments do not rebuild it.
+    const auto fingerprint = EnvLibIndex::makeFingerprint(env);
+    const QString indexFile = DeployCore::getCacheDir() + "/envlibs/" + fingerprint.toHex() + ".index";
 
-        dir.setPath(i);
-        if (!dir.exists()) {
-            continue;
-        }
+    if (QuasarAppUtils::Params::isEndable("clearCache") ||
+            !_envLibs.load(indexFile, fingerprint)) {
 
-        auto list = dir.entryInfoList(QStringList() << "*.dll" << "*.DLL"
-                                      << "*.SO*" << "*.so*",
-                                      QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden);
+        _envLibs.build(env, QStringList() << "*.dll" << "*.DLL" << "*.SO*" << "*.so*");
 
-        for (auto i : list) {
-            addToWinAPI(i.fileName().toUpper(), winAPI);
-            _EnvLibs.insertMulti(i.fileName().toUpper(), i.absoluteFilePath());
+        if (!_envLibs.save(indexFile)) {
+            QuasarAppUtils::Params::verboseLog("Failed to save the environment index into " + indexFile,
+                                               QuasarAppUtils::Warning);
         }
-
     }
 
+#ifdef Q_OS_WIN
+    for (const auto &name: _envLibs.names()) {
+        addToWinAPI(name, winAPI);
+    }
+#endif
 
     _peScaner.setWinAPI(winAPI);
+    _cache.setContext(scanContext());
 }
 
 QSet<LibInfo> DependenciesScanner::scan(const QString &path) {
@@ -209,12 +620,97 @@ QSet<LibInfo> DependenciesScanner::scan(const QString &path) {
         return result;
     }
 
-    QSet<QString> stack;
-    recursiveDep(info, result, stack);
+    info.setPriority(DeployCore::getLibPriority(path));
+
+    prefetch({info});
+
+    int id = _graph.addNode(info);
+    resolve(id);
+
+    const auto &closure = _graph.closure(id);
+    result.reserve(closure.size());
+
+    for (int dep : closure) {
+        result.insert(_graph.info(dep));
+    }
 
     return result;
 }
 
+ScanResult DependenciesScanner::scanMany(const QStringList &paths) {
+    ScanResult result;
+
+    std::function<LibInfo(const QString &)> parse = [this](const QString &file) {
+        LibInfo info;
+        fillLibInfo(info, file);
+        return info;
+    };
+
+    auto roots = QtConcurrent::blockingMapped<QList<LibInfo>>(paths, parse);
+
+    QList<LibInfo> validRoots;
+    for (const auto &root: roots) {
+        if (root.isValid()) {
+            validRoots.push_back(root);
+        }
+    }
+
+    prefetch(validRoots);
+
+    QVector<int> rootIds(paths.size(), -1);
+
+    for (int i = 0; i < paths.size(); ++i) {
+        if (!roots[i].isValid()) {
+            continue;
+        }
+
+        roots[i].setPriority(DeployCore::getLibPriority(paths[i]));
+        rootIds[i] = _graph.addNode(roots[i]);
+        resolve(rootIds[i]);
+    }
+
+    // index of node in the result libs list
+    QVector<int> indexes(_graph.size(), -1);
+
+    for (int i = 0; i < paths.size(); ++i) {
+        const auto &path = paths[i];
+
+        if (result._closures.contains(path)) {
+            continue;
+        }
+
+        result._roots.push_back(path);
+        auto &closure = result._closures[path];
+
+        if (rootIds[i] < 0) {
+            continue;
+        }
+
+        const auto &ids = _graph.closure(rootIds[i]);
+        closure.reserve(ids.size());
+
+        for (int dep : ids) {
+            if (indexes[dep] < 0) {
+                indexes[dep] = result._libs.size();
+                result._libs.push_back(_graph.info(dep));
+            }
+
+            closure.push_back(indexes[dep]);
+        }
+    }
+
+    return result;
+}
+
+void DependenciesScanner::saveCache() {
+    qInfo() << QString("Scan cache: %0 hits, %1 misses, %2 reused closures").
+               arg(_cache.hits()).
+               arg(_cache.misses()).
+               arg(_cache.closureHits());
+
+    _cache.save();
+}
+
 DependenciesScanner::~DependenciesScanner() {
 
 }
@@ -8,12 +8,17 @@
 #ifndef WINDEPENDENCIESSCANNER_H
 #define WINDEPENDENCIESSCANNER_H
 
-#include <QMultiMap>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QVector>
 #include <QStringList>
 #include "deploy_global.h"
 #include "pe.h"
+#include "dependencygraph.h"
 #include "elf.h"
+#include "envlibindex.h"
 #include "libinfo.h"
+#include "scancache.h"
 
 
 enum class PrivateScaner: unsigned char {
@@ -22,22 +27,164 @@ enum class PrivateScaner: unsigned char {
    ELF
 };
 
+/**
+ * @brief The ScanResult class - dependencies of many binaries.
+ * Each library is stored once, the closure of each root is a list of indexes in the libs list.
+ */
+class DEPLOYSHARED_EXPORT ScanResult {
+public:
+    /**
+     * @brief libs - all dependencies of all roots.
+     */
+    const QVector<LibInfo>& libs() const;
+
+    /**
+     * @brief closure
+     * @param root - path of binary that was passed into the scanMany method.
+     * @return indexes of all dependencies of root in the libs list.
+     */
+    QVector<int> closure(const QString& root) const;
+    QSet<LibInfo> closureSet(const QString& root) const;
+
+    QStringList roots() const;
+
+private:
+    QVector<LibInfo> _libs;
+    QHash<QString, QVector<int>> _closures;
+    QStringList _roots;
+
+    friend class DependenciesScanner;
+};
+
 class DEPLOYSHARED_EXPORT DependenciesScanner {
 
 
 private:
 
-    QMultiHash<QString, QString> _EnvLibs;
-    QHash<QString, LibInfo> _scanedLibs;
+    EnvLibIndex _envLibs;
+    DependencyGraph _graph;
+
+    /**
+     * @brief _systemLibs - index of the /lib and /usr/lib trees, it is used if the library
+     *  is not found in the environment and in the ld.so.cache. Built on the first miss.
+     */
+    mutable EnvLibIndex _systemLibs;
+    mutable bool _systemLibsReady = false;
+    mutable QMutex _systemLibsLock;
+
+    /**
+     * @brief _rpathLibs - cache of the rpath dirs listing (key - dir).
+     */
+    QHash<QString, QHash<QString, QString>> _rpathLibs;
+
+    /**
+     * @brief _parsedLibs - thread safe memo of all parsed files (key - path of file).
+     *  Invalid items are files that can not be parsed.
+     */
+    QHash<QString, LibInfo> _parsedLibs;
+
+    /**
+     * @brief _parsedIds - memo of parsed files by the id of file (device and inode),
+     *  so all links to one library are parsed once. Guarded by the _parsedLibsLock.
+     */
+    QHash<QByteArray, LibInfo> _parsedIds;
+    mutable QReadWriteLock _parsedLibsLock;
 
     PE _peScaner;
     ELF _elfScaner;
 
-    PrivateScaner getScaner(const QString& lib) const;
+    ScanCache _cache;
 
-    QMultiMap<LibPriority, LibInfo> getLibsFromEnvirement(const QString& libName) const;
+    PrivateScaner getScaner(const QString& lib) const;
 
-    void recursiveDep(LibInfo& lib, QSet<LibInfo> &res, QSet<QString> &libStack);
+    bool parseLibInfo(LibInfo& info, const QString& file);
+
+    /**
+     * @brief fileId
+     * @return id of file that is same for all links of this file or empty string if file not exists.
+     */
+    static QByteArray fileId(const QString& file);
+
+    /**
+     * @brief prefetch - parse in parallel all libraries that can be dependencies of lib.
+     *  After this all dependencies tree of lib is available from the memo table.
+     */
+    void prefetch(const QList<LibInfo>& libs);
+    /**
+     * @brief getCandidatesFromEnvirement - find libName in the environment dirs and the ld.so.cache.
+     * @param platform - platform of library, used only for the ld.so.cache.
+     */
+    QStringList getCandidatesFromEnvirement(const QString& libName, Platform platform = UnknownPlatform) const;
+
+    /**
+     * @brief getCandidatesFromSystemDirs - find library in the /lib and /usr/lib trees.
+     *  These dirs are not listed at start when the ld.so.cache is used.
+     */
+    QStringList getCandidatesFromSystemDirs(const QString& upperName) const;
+
+    /**
+     * @brief getLibsOfDir - list of libraries of the rpath dir (key - upper name of library).
+     *  Each dir is listed only once.
+     */
+    QHash<QString, QString> getLibsOfDir(const QString& dir);
+
+    /**
+     * @brief getCandidatesFromRpath - find libName in the search paths of lib.
+     * @param preferred - set to true if one of the candidates is qt or extra library.
+     * @return list of candidates in order of the rpath.
+     */
+    QStringList getCandidatesFromRpath(const LibInfo& lib, const QString& libName, bool *preferred = nullptr);
+
+    /**
+     * @brief getCandidates - all files that can be the libName dependency of lib.
+     */
+    QStringList getCandidates(const LibInfo& lib, const QString& libName);
+
+    /**
+     * @brief sortByPriority - stable sort of candidates by priority, without parsing of files.
+     */
+    QStringList sortByPriority(const QStringList& candidates) const;
+
+    /**
+     * @brief probePlatform - platform of file from the memo table or from the header of file.
+     */
+    Platform probePlatform(const QString& file) const;
+
+    /**
+     * @brief isAcceptable - check candidate by the header probe and the ignore list.
+     *  The file is not parsed by this method.
+     */
+    bool isAcceptable(const QString& candidate, Platform platform) const;
+
+    /**
+     * @brief selectCandidate - find first acceptable candidate that can be parsed.
+     *  Only the selected candidate is parsed, if it fails then the next candidate is checked.
+     * @param candidates - candidates sorted by priority
+     * @param result - parsed library
+     * @return true if library is found.
+     */
+    bool selectCandidate(const QStringList& candidates, const QString& libName,
+                         Platform platform, LibInfo& result);
+
+    /**
+     * @brief getLibFromEnvirement - find the libName dependency of lib.
+     *  The search paths of lib are checked before the environment.
+     * @return true if library is found.
+     */
+    bool getLibFromEnvirement(const LibInfo& lib, const QString& libName, LibInfo& result);
+
+    /**
+     * @brief loadClosure - load all dependencies of node from the scan cache.
+     * @return true if the cache contains valid closure of node.
+     */
+    bool loadClosure(int id);
+    QByteArray scanContext() const;
+
+    /**
+     * @brief resolve - find dependencies of node and of all reached nodes of the graph.
+     *  The closures of all resolved nodes are saved into the scan cache.
+     */
+    void resolve(int root);
 
     void addToWinAPI(const QString& lib, QHash<WinAPI, QSet<QString> > &res);
 
@@ -47,7 +194,20 @@ public:
     void setEnvironment(const QStringList &env);
 
     QSet<LibInfo> scan(const QString& path);
-    bool fillLibInfo(LibInfo& info ,const QString& file) const;
+
+    /**
+     * @brief scanMany - find dependencies of all binaries in one pass.
+     *  The roots are parsed in parallel and the dependencies of all roots are prefetched together,
+     *  so the common dependencies are parsed and resolved only once.
+     * @param paths - list of binaries
+     */
+    ScanResult scanMany(const QStringList& paths);
+    bool fillLibInfo(LibInfo& info ,const QString& file);
+
+    /**
+     * @brief saveCache - save the scan cache on disk and print statistic of it.
+     */
+    void saveCache();
 
     ~DependenciesScanner();
 
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "dependencygraph.h"
+
+#include <algorithm>
+
+DependencyGraph::DependencyGraph() {
+
+}
+
+int DependencyGraph::addNode(const LibInfo &info) {
+    auto path = info.fullPath();
+    auto it = _ids.constFind(path);
+
+    if (it != _ids.constEnd()) {
+        return *it;
+    }
+
+    int id = _nodes.size();
+    Node node;
+    node.info = info;
+
+    _nodes.push_back(node);
+    _ids.insert(path, id);
+
+    return id;
+}
+
+int DependencyGraph::find(const QString &path) const {
+    return _ids.value(path, -1);
+}
+
+const LibInfo &DependencyGraph::info(int id) const {
+    return _nodes[id].info;
+}
+
+int DependencyGraph::size() const {
+    return _nodes.size();
+}
+
+bool DependencyGraph::isResolved(int id) const {
+    return _nodes[id].resolved || _nodes[id].closureReady;
+}
+
+void DependencyGraph::setEdges(int id, const QVector<int> &edges) {
+    auto &node = _nodes[id];
+    node.edges = edges;
+    node.resolved = true;
+}
+
+const QVector<int> &DependencyGraph::edges(int id) const {
+    return _nodes[id].edges;
+}
+
+void DependencyGraph::setClosure(int id, QVector<int> closure, WinAPI winApi) {
+    std::sort(closure.begin(), closure.end());
+    closure.erase(std::unique(closure.begin(), closure.end()), closure.end());
+    closure.removeAll(id);
+
+    auto &node = _nodes[id];
+    node.closure = closure;
+    node.closureWinApi = winApi | node.info.getWinApi();
+    node.closureReady = true;
+}
+
+bool DependencyGraph::hasClosure(int id) const {
+    return _nodes[id].closureReady;
+}
+
+const QVector<int> &DependencyGraph::closure(int id) {
+    if (_nodes[id].closureReady) {
+        return _nodes[id].closure;
+    }
+
+    QVector<bool> visited(_nodes.size(), false);
+    QVector<int> stack = {id};
+    QVector<int> result;
+    WinAPI winApi = _nodes[id].info.getWinApi();
+
+    visited[id] = true;
+
+    while (stack.size()) {
+        int current = stack.takeLast();
+        const auto &node = _nodes[current];
+
+        if (current != id) {
+            result.push_back(current);
+            winApi = winApi | node.info.getWinApi();
+        }
+
+        // the closure of this node is already known, so do not walk it again.
+        if (current != id && node.closureReady) {
+            winApi = winApi | node.closureWinApi;
+
+            for (int dep: node.closure) {
+                if (!visited[dep]) {
+                    visited[dep] = true;
+                    result.push_back(dep);
+                }
+            }
+
+            continue;
+        }
+
+        for (int dep: node.edges) {
+            if (!visited[dep]) {
+                visited[dep] = true;
+                stack.push_back(dep);
+            }
+        }
+    }
+
+    setClosure(id, result, winApi);
+
+    return _nodes[id].closure;
+}
+
+WinAPI DependencyGraph::closureWinApi(int id) {
+    closure(id);
+    return _nodes[id].closureWinApi;
+}
+
+void DependencyGraph::clear() {
+    _nodes.clear();
+    _ids.clear();
+}
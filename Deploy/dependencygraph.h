@@ -0,0 +1,90 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef DEPENDENCYGRAPH_H
+#define DEPENDENCYGRAPH_H
+
+#include <QHash>
+#include <QVector>
+#include "deploy_global.h"
+#include "libinfo.h"
+
+/**
+ * @brief The DependencyGraph class - graph of resolved dependencies of libraries.
+ * Each library is a node with an integer id. Nodes keep the direct dependencies (edges)
+ * and the lazily computed transitive dependencies (closure) as sorted vectors of ids.
+ */
+class DEPLOYSHARED_EXPORT DependencyGraph
+{
+public:
+    DependencyGraph();
+
+    /**
+     * @brief addNode - add library into graph.
+     * @return id of node. If the node of this library already exists then returns its id.
+     */
+    int addNode(const LibInfo& info);
+
+    /**
+     * @brief find
+     * @return id of node of the library with path or -1.
+     */
+    int find(const QString& path) const;
+
+    const LibInfo& info(int id) const;
+    int size() const;
+
+    /**
+     * @brief isResolved
+     * @return true if the edges or the closure of node are known.
+     */
+    bool isResolved(int id) const;
+
+    /**
+     * @brief setEdges - sets the direct dependencies of node.
+     */
+    void setEdges(int id, const QVector<int>& edges);
+    const QVector<int>& edges(int id) const;
+
+    /**
+     * @brief setClosure - sets known closure of node (for example from the scan cache).
+     * @param closure - ids of all dependencies of node
+     * @param winApi - all WinApi of closure
+     */
+    void setClosure(int id, QVector<int> closure, WinAPI winApi);
+
+    /**
+     * @brief closure - all dependencies of node.
+     *  The closure is computed once, the closures of reached nodes are reused.
+     *  Cycles are supported, the node itself is not a part of own closure.
+     * @return sorted vector of ids.
+     */
+    const QVector<int>& closure(int id);
+    bool hasClosure(int id) const;
+
+    /**
+     * @brief closureWinApi - WinApi of node and of all nodes of its closure.
+     */
+    WinAPI closureWinApi(int id);
+
+    void clear();
+
+private:
+    struct Node {
+        LibInfo info;
+        QVector<int> edges;
+        QVector<int> closure;
+        WinAPI closureWinApi = WinAPI::NoWinAPI;
+        bool resolved = false;
+        bool closureReady = false;
+    };
+
+    QVector<Node> _nodes;
+    QHash<QString, int> _ids;
+};
+
+#endif // DEPENDENCYGRAPH_H
@@ -79,6 +79,7 @@ bool Deploy::deploy() {
     switch (DeployCore::getMode() ) {
     case RunMode::Deploy:
         _extracter->deploy();
+        _scaner->saveCache();
         break;
     case RunMode::Clear:
         _extracter->clear();
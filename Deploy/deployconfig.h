@@ -5,6 +5,7 @@
 #include "distromodule.h"
 #include "extra.h"
 #include "ignorerule.h"
+#include "ldcache.h"
 #include "qtdir.h"
 #include "targetinfo.h"
 
@@ -51,6 +52,11 @@ public:
      */
     Envirement envirement;
 
+    /**
+     * @brief ldCache - system libraries of the /etc/ld.so.cache (only linux)
+     */
+    LdCache ldCache;
+
     /**
      * @brief reset config file to default
      */
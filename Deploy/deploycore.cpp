@@ -12,8 +12,11 @@
 
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QLibraryInfo>
+#include <QStandardPaths>
+#include <QTextStream>
 #include <configparser.h>
 
 //QString DeployCore::qtDir = "";
@@ -183,16 +186,25 @@ void DeployCore::help() {
                 {"noStrip", "Skips strip step"},
                 {"noTranslations", "Skips the translations files. It doesn't work without qmake and inside a snap package"},
                 {"noOverwrite", "Prevents replacing existing files."},
+                {"incremental", "Skips copying of files that are not changed since the previous deployment."
+                 " Files are compared by size and modification time, and by content if they are ambiguous."},
+                {"hardlink", "Creates hard links instead of copies of files if the target dir is on the same file system."
+                 " The deployed files share data with the source files, so use it only for temporary distributions (not supported on windows)."
+                 " Hard-linked files are not stripped, because the strip would change the source files."},
+                {"keepSymlinks", "Copies the links of libraries (libA.so.5 -> libA.so.5.14.2) as links,"
+                 " so the content of one library is not duplicated for each of its names (only linux)."},
                 {"noCheckRPATH", "Disables automatic search of paths to qmake in executable files."},
                 {"noCheckPATH", "Disables automatic search of paths to qmake in system PATH."},
+                {"noLdCache", "Disables reading of the /etc/ld.so.cache file. System libraries will be searched in the /lib and /usr/lib dirs (only linux)."},
                 {"v / version", "Shows compiled version"},
                 {"extractPlugins", "This flag will cause cqtdeployer to retrieve dependencies from plugins. Starting with version 1.4,"
                  " this option has been disabled by default, as it can add low-level graphics libraries to the distribution,"
                  " which will not be compatible with equipment on users' hosts."},
-                {"allQmlDependes", "Extracts all the qml libraries. (not recommended, as it takes great amount of computer memory)"},
+                {"allQmlDependes", "Extracts all the qml libraries. (not recommended, as it takes great amount of disk space)"},
                 {"qif", "Create the QIF installer for deployement programm"},
                 {"deploySystem", "Deploys all libraries  (do not work in snap )"},
                 {"deploySystem-with-libc", "deploy all libs libs (only linux) (do not work in snap )"},
+                {"clearCache", "Invalidates the cache of scanned dependencies before deployment."},
 
             }
         },
@@ -216,6 +228,10 @@ void DeployCore::help() {
                 {"-extraPlugin [list,params]", "Sets an additional path to extraPlugin of an app"},
                 {"-recursiveDepth [params]", "Sets the Depth of recursive search of libs (default 0)"},
                 {"-targetDir [params]", "Sets target directory(by default it is the path to the first deployable file)"},
+                {"-debugSymbolsDir [params]", "Saves the debug info of the stripped libraries into the separate .debug files of this directory"
+                 " (the structure of the target directory is repeated). The stripped libraries are linked with them by the .gnu_debuglink section (only linux)."},
+                {"-dedup [hardlink|symlink]", "Writes the same content that is copied into several packages only once."
+                 " The other copies are created as hard links (by default) or as relative symlinks (symlinks are supported only on linux)."},
                 {"-verbose [0-3]", "Shows debug log"},
 
             }
@@ -282,13 +298,20 @@ QStringList DeployCore::helpKeys() {
         "qif",
         "noCheckRPATH",
         "noCheckPATH",
+        "noLdCache",
         "name",
         "description",
         "deployVersion",
         "releaseDate",
         "icon",
         "publisher",
-        "customScript"
+        "customScript",
+        "clearCache",
+        "hardlink",
+        "incremental",
+        "debugSymbolsDir",
+        "keepSymlinks",
+        "dedup"
     };
 }
 
@@ -354,6 +377,32 @@ QString DeployCore::findProcess(const QString &env, const QString& proc) {
     return "";
 }
 
+QString DeployCore::getCacheDir() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+}
+
+qint64 DeployCore::peakMemoryUsage() {
+#ifdef Q_OS_LINUX
+    QFile status("/proc/self/status");
+
+    if (!status.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+
+    QTextStream stream(&status);
+    QString line;
+
+    while (stream.readLineInto(&line)) {
+        if (line.startsWith("VmHWM:")) {
+            // the value is in kB.
+            return line.mid(6).simplified().section(' ', 0, 0).toLongLong() * 1024;
+        }
+    }
+#endif
+
+    return -1;
+}
+
 int DeployCore::find(const QString &str, const QStringList &list) {
     for (int i = 0 ; i < list.size(); ++i) {
         if (list[i].contains(str))
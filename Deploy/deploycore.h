@@ -175,6 +175,17 @@ public:
                                           int lastLvl = 2);
     static QString findProcess(const QString& env, const QString& proc);
 
+    /**
+     * @brief getCacheDir
+     * @return path to directory with persistent caches of cqtdeployer
+     */
+    static QString getCacheDir();
+
+    /**
+     * @brief peakMemoryUsage
+     * @return peak resident memory of this process in bytes (VmHWM on linux), -1 if it is unknown.
+     */
+    static qint64 peakMemoryUsage();
 
 };
 
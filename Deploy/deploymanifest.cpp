@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "deploymanifest.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <cstring>
+#include <quasarapp.h>
+
+#define MANIFEST_MAGIC   0x4d445143 // CQDM
+#define MANIFEST_VERSION 2
+
+// magic, version and reserved 8 bytes.
+#define HEADER_SIZE 16
+
+// path size, flags, size, mtime, hash, source size, source mtime. The path is padded to 8 bytes.
+#define RECORD_HEADER_SIZE 48
+
+#define FLAG_HAS_INFO   0x1
+#define FLAG_HAS_SOURCE 0x2
+
+static quint64 alignRecord(quint64 size) {
+    return (size + 7) / 8 * 8;
+}
+
+DeployManifest::DeployManifest() {
+}
+
+DeployManifest::~DeployManifest() {
+    close();
+}
+
+QString DeployManifest::manifestFile(const QString &targetDir) {
+    auto key = QCryptographicHash::hash(QFileInfo(targetDir).absoluteFilePath().toUtf8(),
+                                        QCryptographicHash::Sha1).toHex();
+
+    // the cache dir can be cleared by the system, the lost manifest leaves the old files in the target dir.
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/manifests/" + key + ".manifest";
+}
+
+quint64 DeployManifest::contentHash(const QString &file) {
+    QFile source(file);
+
+    if (!source.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    if (!hash.addData(&source)) {
+        return 0;
+    }
+
+    return contentHash(hash.result());
+}
+
+quint64 DeployManifest::contentHash(const QByteArray &sha1) {
+    if (sha1.size() < static_cast<int>(sizeof(quint64))) {
+        return 0;
+    }
+
+    // the first 64 bits of sha1.
+    return qFromLittleEndian<quint64>(sha1.constData());
+}
+
+void DeployManifest::close() {
+    _records.clear();
+    _index.clear();
+
+    if (_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+        _data = nullptr;
+    }
+
+    _file.close();
+
+    QMutexLocker locker(&_appendLock);
+    _appendFile.close();
+    _appended.clear();
+}
+
+bool DeployManifest::load() {
+    close();
+
+    _file.setFileName(_manifestFile);
+
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const auto fileSize = static_cast<quint64>(_file.size());
+
+    if (fileSize < HEADER_SIZE) {
+        _file.close();
+        return false;
+    }
+
+    _data = _file.map(0, _file.size());
+
+    if (!_data) {
+        _file.close();
+        return false;
+    }
+
+    if (qFromLittleEndian<quint32>(_data) != MANIFEST_MAGIC ||
+            qFromLittleEndian<quint32>(_data + 4) != MANIFEST_VERSION) {
+
+        QuasarAppUtils::Params::verboseLog("The deploy manifest " + _manifestFile + " has unsupported format",
+                                           QuasarAppUtils::Warning);
+        close();
+
+        // the new records will be written into the new manifest.
+        QFile::remove(_manifestFile);
+        return false;
+    }
+
+    quint64 offset = HEADER_SIZE;
+
+    while (offset + RECORD_HEADER_SIZE <= fileSize) {
+        auto pathSize = qFromLittleEndian<quint32>(_data + offset);
+        quint64 recordSize = alignRecord(RECORD_HEADER_SIZE + static_cast<quint64>(pathSize));
+
+        if (offset + recordSize > fileSize) {
+            break;
+        }
+
+        Record record;
+        record.flags = qFromLittleEndian<quint32>(_data + offset + 4);
+        record.size = qFromLittleEndian<qint64>(_data + offset + 8);
+        record.mtime = qFromLittleEndian<qint64>(_data + offset + 16);
+        record.hash = qFromLittleEndian<quint64>(_data + offset + 24);
+        record.sourceSize = qFromLittleEndian<qint64>(_data + offset + 32);
+        record.sourceMtime = qFromLittleEndian<qint64>(_data + offset + 40);
+
+        // the path is not copied, it refers to the mapped data.
+        record.path = QByteArray::fromRawData(reinterpret_cast<const char*>(_data + offset + RECORD_HEADER_SIZE),
+                                              static_cast<int>(pathSize));
+
+        auto it = _index.find(record.path);
+        if (it != _index.end()) {
+            _records[it.value()] = record;
+        } else {
+            _index.insert(record.path, _records.size());
+            _records.push_back(record);
+        }
+
+        offset += recordSize;
+    }
+
+    // the tail of interrupted write, the new records should be appended after the last valid record.
+    if (offset != fileSize) {
+        QuasarAppUtils::Params::verboseLog("The deploy manifest " + _manifestFile + " has broken tail",
+                                           QuasarAppUtils::Warning);
+
+        // the paths of records refer to the mapped data, so the file is closed before the resize and loaded again.
+        close();
+
+        if (!QFile::resize(_manifestFile, static_cast<qint64>(offset))) {
+            QuasarAppUtils::Params::verboseLog("Failed to cut the broken tail of the deploy manifest " + _manifestFile,
+                                               QuasarAppUtils::Warning);
+            return false;
+        }
+
+        return load();
+    }
+
+    return true;
+}
+
+QByteArray DeployManifest::toRecord(const Record &record) {
+    QByteArray data(static_cast<int>(alignRecord(RECORD_HEADER_SIZE +
+                                                 static_cast<quint64>(record.path.size()))), 0);
+
+    auto dest = data.data();
+    qToLittleEndian<quint32>(static_cast<quint32>(record.path.size()), dest);
+    qToLittleEndian<quint32>(record.flags, dest + 4);
+    qToLittleEndian<qint64>(record.size, dest + 8);
+    qToLittleEndian<qint64>(record.mtime, dest + 16);
+    qToLittleEndian<quint64>(record.hash, dest + 24);
+    qToLittleEndian<qint64>(record.sourceSize, dest + 32);
+    qToLittleEndian<qint64>(record.sourceMtime, dest + 40);
+    memcpy(dest + RECORD_HEADER_SIZE, record.path.constData(), static_cast<size_t>(record.path.size()));
+
+    return data;
+}
+
+DeployManifestItem DeployManifest::toItem(const Record &record) {
+    DeployManifestItem item;
+    item.path = QString::fromUtf8(record.path);
+    item.size = record.size;
+    item.mtime = record.mtime;
+    item.hash = record.hash;
+    item.sourceSize = record.sourceSize;
+    item.sourceMtime = record.sourceMtime;
+    item.hasInfo = record.flags & FLAG_HAS_INFO;
+    item.hasSource = record.flags & FLAG_HAS_SOURCE;
+
+    return item;
+}
+
+static QByteArray manifestHeader() {
+    QByteArray header(HEADER_SIZE, 0);
+    qToLittleEndian<quint32>(MANIFEST_MAGIC, header.data());
+    qToLittleEndian<quint32>(MANIFEST_VERSION, header.data() + 4);
+
+    return header;
+}
+
+bool DeployManifest::openForAppend() {
+    if (_appendFile.isOpen()) {
+        return true;
+    }
+
+    if (_manifestFile.isEmpty()) {
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(_manifestFile).absolutePath());
+
+    _appendFile.setFileName(_manifestFile);
+
+    if (!_appendFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+
+    if (_appendFile.size() < HEADER_SIZE) {
+        _appendFile.resize(0);
+        _appendFile.write(manifestHeader());
+    }
+
+    return true;
+}
+
+bool DeployManifest::appendRecord(const Record &record) {
+    if (!openForAppend()) {
+        return false;
+    }
+
+    _appended.insert(record.path, record);
+
+    auto data = toRecord(record);
+    return _appendFile.write(data) == data.size();
+}
+
+bool DeployManifest::append(const QString &path, const QString &source, quint64 hash) {
+    Record record;
+    record.path = path.toUtf8();
+    record.hash = hash;
+
+    if (source.size()) {
+        QFileInfo info(source);
+
+        if (info.isFile()) {
+            record.sourceSize = info.size();
+            record.sourceMtime = info.lastModified().toMSecsSinceEpoch();
+            record.flags = FLAG_HAS_SOURCE;
+        }
+    }
+
+    QMutexLocker locker(&_appendLock);
+    return appendRecord(record);
+}
+
+bool DeployManifest::updateHash(const QString &path, quint64 hash) {
+    const auto key = path.toUtf8();
+
+    QMutexLocker locker(&_appendLock);
+
+    Record record;
+    auto appended = _appended.constFind(key);
+    auto loaded = _index.constFind(key);
+
+    if (appended != _appended.constEnd()) {
+        record = appended.value();
+    } else if (loaded != _index.constEnd()) {
+        record = _records.at(loaded.value());
+    } else {
+        return false;
+    }
+
+    record.path = key;
+    record.hash = hash;
+
+    return appendRecord(record);
+}
+
+bool DeployManifest::save(const QStringList &paths) {
+    if (_manifestFile.isEmpty()) {
+        return false;
+    }
+
+    QVector<Record> records;
+    records.reserve(paths.size());
+
+    {
+        QMutexLocker locker(&_appendLock);
+
+        for (const auto &path: paths) {
+            Record record;
+            record.path = path.toUtf8();
+
+            // the file that is not copied in this run keeps the record of the previous deploy.
+            auto appended = _appended.constFind(record.path);
+            auto loaded = _index.constFind(record.path);
+
+            if (appended != _appended.constEnd()) {
+                record = appended.value();
+
+                // the size and the time are read at the end, the copy time and the strip change them.
+                QFileInfo info(path);
+                record.flags &= ~static_cast<quint32>(FLAG_HAS_INFO);
+
+                if (info.isFile()) {
+                    record.size = info.size();
+                    record.mtime = info.lastModified().toMSecsSinceEpoch();
+                    record.flags |= FLAG_HAS_INFO;
+                }
+
+            } else if (loaded != _index.constEnd()) {
+                record = _records.at(loaded.value());
+            }
+
+            // the path of loaded record refers to the mapped data, that is closed before the replacing of file.
+            record.path = path.toUtf8();
+            records.push_back(record);
+        }
+    }
+
+    QDir().mkpath(QFileInfo(_manifestFile).absolutePath());
+
+    const QString temp = _manifestFile + ".tmp";
+    QFile file(temp);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QuasarAppUtils::Params::verboseLog("Failed to save the deploy manifest into " + _manifestFile,
+                                           QuasarAppUtils::Warning);
+        return false;
+    }
+
+    bool result = file.write(manifestHeader()) == HEADER_SIZE;
+
+    for (const auto &record: records) {
+        auto data = toRecord(record);
+        result = result && file.write(data) == data.size();
+    }
+
+    file.close();
+
+    // the old map should be closed before the replacing of file.
+    close();
+
+    if (!result || (QFile::exists(_manifestFile) && !QFile::remove(_manifestFile)) ||
+            !QFile::rename(temp, _manifestFile)) {
+
+        QFile::remove(temp);
+        QuasarAppUtils::Params::verboseLog("Failed to save the deploy manifest into " + _manifestFile,
+                                           QuasarAppUtils::Warning);
+        return false;
+    }
+
+    return load();
+}
+
+QStringList DeployManifest::paths() const {
+    QStringList result;
+    result.reserve(_records.size());
+
+    for (const auto &record: _records) {
+        result.push_back(QString::fromUtf8(record.path));
+    }
+
+    return result;
+}
+
+bool DeployManifest::find(const QString &path, DeployManifestItem &item) const {
+    const auto key = path.toUtf8();
+
+    {
+        QMutexLocker locker(&_appendLock);
+        auto appended = _appended.constFind(key);
+
+        if (appended != _appended.constEnd()) {
+            item = toItem(appended.value());
+            return true;
+        }
+    }
+
+    auto it = _index.find(key);
+
+    if (it == _index.end()) {
+        return false;
+    }
+
+    item = toItem(_records[it.value()]);
+    return true;
+}
+
+int DeployManifest::size() const {
+    return _records.size();
+}
+
+QString DeployManifest::getManifestFile() const {
+    return _manifestFile;
+}
+
+void DeployManifest::setManifestFile(const QString &manifestFile) {
+    close();
+    _manifestFile = manifestFile;
+}
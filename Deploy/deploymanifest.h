@@ -0,0 +1,159 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef DEPLOYMANIFEST_H
+#define DEPLOYMANIFEST_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <QVector>
+#include "deploy_global.h"
+
+/**
+ * @brief The DeployManifestItem struct - one deployed file of the manifest.
+ */
+struct DEPLOYSHARED_EXPORT DeployManifestItem {
+    QString path;
+
+    /// size and modification time (msecs since epoch) of the deployed file at the end of deploy.
+    qint64 size = 0;
+    qint64 mtime = 0;
+
+    /// 64 bit hash of the content of deployed file (see contentHash), 0 if it is unknown.
+    quint64 hash = 0;
+
+    /// size and modification time of the source file at the time of copy.
+    qint64 sourceSize = 0;
+    qint64 sourceMtime = 0;
+
+    /// false if the size and the time of the deployed file are unknown (item of directory or interrupted deploy).
+    bool hasInfo = false;
+
+    /// false if the source is unknown (item of directory, moved or generated file).
+    bool hasSource = false;
+};
+
+/**
+ * @brief The DeployManifest class - the binary list of the deployed files of one target dir.
+ * The file contains the header and the records (path, size, modification time and content hash of the deployed file,
+ * size and modification time of its source). The hash and the source are recorded while copying, so the manifest
+ * is saved without reading the deployed files. Paths are appended while deploying
+ * (the list is not lost if deploy is interrupted), the save method rewrites the manifest with one record per path.
+ * The loaded manifest is mapped into memory, the later records of path replace the earlier.
+ * The append method is thread safe.
+ */
+class DEPLOYSHARED_EXPORT DeployManifest
+{
+public:
+    DeployManifest();
+    ~DeployManifest();
+
+    /**
+     * @brief manifestFile
+     * @return path of the manifest of the target dir (it is saved in the app data dir).
+     */
+    static QString manifestFile(const QString& targetDir);
+
+    /**
+     * @brief contentHash - 64 bit hash of the content of file.
+     * @return 0 if file can not be read.
+     */
+    static quint64 contentHash(const QString& file);
+
+    /**
+     * @brief contentHash
+     * @return the 64 bit hash from the result of sha1, it is same as the contentHash of hashed data.
+     */
+    static quint64 contentHash(const QByteArray& sha1);
+
+    /**
+     * @brief load - map the manifest file and index the records.
+     *  The broken tail of the interrupted write is cut.
+     * @return false if file not exists or it has unsupported format.
+     */
+    bool load();
+
+    /**
+     * @brief append - add the record of path to the end of manifest.
+     * @param source - the file that was copied into the path, the record is without source if it is empty.
+     * @param hash - the content hash of path computed while copying, 0 if it is unknown.
+     */
+    bool append(const QString& path, const QString& source = QString(), quint64 hash = 0);
+
+    /**
+     * @brief updateHash - replace the hash of the deployed path after the change of its content.
+     *  The paths that are not deployed are ignored.
+     */
+    bool updateHash(const QString& path, quint64 hash);
+
+    /**
+     * @brief save - rewrite the manifest with the records of paths.
+     *  The records appended in this run replace the loaded records, their size and time are read from the files.
+     *  The paths without records are saved without info.
+     */
+    bool save(const QStringList& paths);
+
+    /**
+     * @brief paths
+     * @return list of the loaded paths.
+     */
+    QStringList paths() const;
+
+    /**
+     * @brief find - find the last appended or the loaded record of path.
+     *  The size and the time of appended record are known only after save.
+     *  Can be called while the records are appended.
+     */
+    bool find(const QString& path, DeployManifestItem& item) const;
+
+    int size() const;
+
+    QString getManifestFile() const;
+    void setManifestFile(const QString &manifestFile);
+
+private:
+    struct Record {
+        QByteArray path;
+        qint64 size = 0;
+        qint64 mtime = 0;
+        quint64 hash = 0;
+        qint64 sourceSize = 0;
+        qint64 sourceMtime = 0;
+        quint32 flags = 0;
+    };
+
+    bool appendRecord(const Record& record);
+
+    bool openForAppend();
+    void close();
+    static QByteArray toRecord(const Record& record);
+    static DeployManifestItem toItem(const Record& record);
+
+    QString _manifestFile;
+
+    QFile _file;
+    const uchar* _data = nullptr;
+
+    QFile _appendFile;
+
+    /**
+     * @brief _appended - the last appended record of each path, guarded by the _appendLock.
+     */
+    QHash<QByteArray, Record> _appended;
+    mutable QMutex _appendLock;
+
+    /**
+     * @brief _records - the loaded records, paths are the raw data of the mapped file.
+     */
+    QVector<Record> _records;
+    QHash<QByteArray, int> _index;
+};
+
+#endif // DEPLOYMANIFEST_H
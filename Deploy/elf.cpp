@@ -6,8 +6,12 @@
 //#
 
 #include "elf.h"
+#include "mappedelf.h"
 #include <cmath>
+#include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QSysInfo>
 #include <quasarapp.h>
 
 ELF::ELF()
@@ -15,17 +19,67 @@ ELF::ELF()
 
 }
 
-QByteArrayList ELF::getDynamicString(ElfReader& reader) const {
-    auto headers = reader.readHeaders();
+QString ELF::getQtPath(const QString &rpath) const {
+    const auto dirs = rpath.split(':', QString::SkipEmptyParts);
 
-    for (const auto &sectionHeader : headers.sectionHeaders) {
-        if (sectionHeader.name == ".dynstr") {
-            auto arr = reader.readSection(sectionHeader.name).split(0);
-            return arr;
+    for (const auto &dir: dirs) {
+        // the dirs relative to the library can not be a dir of the qt installation.
+        if (dir.contains('$')) {
+            continue;
         }
+
+        if (QFileInfo(dir).isDir()) {
+            return dir;
+        }
+    }
+
+    return "";
+}
+
+static QString platformToken(Platform platform) {
+    auto arch = QSysInfo::currentCpuArchitecture();
+    bool arm = arch.startsWith("arm");
+
+    if (platform == Unix64) {
+        return (arm)? "aarch64": "x86_64";
+    }
+
+    return (arm)? "v7l": "i686";
+}
+
+QStringList ELF::getSearchPaths(const LibInfo &info) {
+    QStringList result;
+
+    if (info.getRpath().isEmpty()) {
+        return result;
     }
 
-    return {};
+    const QString origin = info.getPath();
+    const QString platform = platformToken(info.getPlatform());
+
+    const auto dirs = info.getRpath().split(':', QString::SkipEmptyParts);
+    for (auto dir: dirs) {
+        if (dir.contains('$')) {
+            // the value of $LIB is built into the loader (lib64, lib/x86_64-linux-gnu on multiarch),
+            // so these dirs are not guessed.
+            if (dir.contains("$LIB") || dir.contains("${LIB}")) {
+                QuasarAppUtils::Params::verboseLog("The rpath dir " + dir + " of " + info.fullPath() +
+                                                   " uses $LIB and is skipped", QuasarAppUtils::Info);
+                continue;
+            }
+
+            dir.replace("${ORIGIN}", origin).replace("$ORIGIN", origin);
+            dir.replace("${PLATFORM}", platform).replace("$PLATFORM", platform);
+        }
+
+        dir = QDir::cleanPath(dir);
+
+        if (!result.contains(dir)) {
+            result.push_back(dir);
+        }
+    }
+
+    return result;
 }
 
 int ELF::getVersionOfTag(const QByteArray& tag, QByteArray& source) const {
@@ -50,42 +104,69 @@ int ELF::getVersionOfTag(const QByteArray& tag, QByteArray& source) const {
     return ver;
 }
 
+Platform ELF::probePlatform(const QString &lib) const {
+    QFile file(lib);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return UnknownPlatform;
+    }
+
+    // magic (4 bytes) and class of file (EI_CLASS).
+    auto ident = file.read(5);
+
+    if (ident.size() != 5 || !ident.startsWith("\x7F" "ELF")) {
+        return UnknownPlatform;
+    }
+
+    if (ident[4] == MappedElf::ElfClass32) {
+        return Unix32;
+    }
+
+    if (ident[4] == MappedElf::ElfClass64) {
+        return Unix64;
+    }
+
+    return UnknownPlatform;
+}
+
 bool ELF::getLibInfo(const QString &lib, LibInfo &info) const {
-    ElfReader reader(lib);
+    MappedElf elf(lib);
 
-    auto headers = reader.readHeaders();
+    if (!elf.open()) {
+        info.setPlatform(UnknownPlatform);
+        return false;
+    }
 
-    if (headers.elfclass == ElfClass::Elf_ELFCLASS32) {
+    if (elf.elfClass() == MappedElf::ElfClass32) {
         info.setPlatform(Unix32);
-    } else if (headers.elfclass == ElfClass::Elf_ELFCLASS64) {
+    } else if (elf.elfClass() == MappedElf::ElfClass64) {
         info.setPlatform(Unix64);
     } else {
         info.setPlatform(UnknownPlatform);
         return false;
     }
 
-    if (!QuasarAppUtils::Params::isEndable("noCheckRPATH")) {
-        auto dynStr = getDynamicString(reader);
-
-        for (auto i = dynStr.rbegin(); i != dynStr.rend(); ++i) {
-
-            if (i->contains("end_")) {
-                break;
-            }
+    QFileInfo fileInfo(lib);
+    info.setName(fileInfo.fileName());
+    info.setPath(fileInfo.absolutePath());
 
-            if (QFileInfo(*i).isDir()) {
-                info.setQtPath(*i);
-            }
+    if (!elf.readDynamic()) {
+        // static executables do not contain the dynamic segment.
+        return true;
+    }
 
-        }
+    // the DT_RUNPATH overrides the DT_RPATH, see the ld.so manual.
+    const char* rpath = (elf.runpath())? elf.runpath(): elf.rpath();
+    if (rpath) {
+        info.setRpath(QString::fromUtf8(rpath));
     }
 
-    info.setName(QFileInfo(lib).fileName());
-    info.setPath(QFileInfo(lib).absolutePath());
+    if (!QuasarAppUtils::Params::isEndable("noCheckRPATH")) {
+        info.setQtPath(getQtPath(info.getRpath()));
+    }
 
-    auto dep = reader.dependencies();
-    for (const auto &i : dep) {
-        info.addDependncies(i.toUpper());
+    for (const char* dep : elf.needed()) {
+        info.addDependncies(QString::fromUtf8(dep).toUpper());
     }
 
     return true;
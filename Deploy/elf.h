@@ -7,15 +7,20 @@
 
 #ifndef ELF_H
 #define ELF_H
-#include "../qtTools/src/shared/winutils/elfreader.h"
-
 #include "igetlibinfo.h"
 
+class MappedElf;
+
 class ELF : public IGetLibInfo
 {
 
 private:
-    QByteArrayList getDynamicString(ElfReader &reader) const;
+    /**
+     * @brief getQtPath - find the qt libraries dir from the rpath of binary file.
+     * @param rpath - value of the DT_RUNPATH or DT_RPATH tag.
+     * @return first existing absolute dir of the rpath or empty string.
+     */
+    QString getQtPath(const QString &rpath) const;
 
     int getVersionOfTag(const QByteArray &tag, QByteArray &source) const;
 
@@ -23,6 +28,16 @@ public:
     ELF();
 
     bool getLibInfo(const QString &lib, LibInfo &info) const override;
+    Platform probePlatform(const QString &lib) const override;
+
+    /**
+     * @brief getSearchPaths - expand the rpath of library into list of dirs.
+     *  The $ORIGIN and $PLATFORM tokens (and the ${} forms of them) are replaced like the dynamic linker does it.
+     *  The dirs with the $LIB token are skipped, its value depends on the build of the dynamic linker.
+     * @param info - library with rpath
+     * @return list of dirs in order of searching.
+     */
+    static QStringList getSearchPaths(const LibInfo &info);
 };
 
 #endif // ELF_H
@@ -0,0 +1,637 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "deploymanifest.h"
+#include "elfstrip.h"
+#include "mappedelf.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QVector>
+#include <QtEndian>
+
+#ifdef Q_OS_WIN
+#include "windows.h"
+#else
+#include <cstdio>
+#endif
+
+#define SHT_NULL     0
+#define SHT_PROGBITS 1
+#define SHT_RELA     4
+#define SHT_NOTE     7
+#define SHT_NOBITS   8
+#define SHT_REL      9
+
+#define SHF_ALLOC       0x2
+#define SHF_INFO_LINK   0x40
+
+#define ELF32_HEADER_SIZE   52
+#define ELF64_HEADER_SIZE   64
+#define ELF32_SECTION_SIZE  40
+#define ELF64_SECTION_SIZE  64
+
+#define DEBUG_LINK_NAME ".gnu_debuglink"
+
+static quint64 alignTo(quint64 value, quint64 align) {
+    if (align < 2) {
+        return value;
+    }
+
+    return (value + align - 1) / align * align;
+}
+
+template<typename T>
+static void put(QByteArray &data, quint64 offset, T value, bool littleEndian) {
+    auto dest = data.data() + offset;
+
+    if (littleEndian) {
+        qToLittleEndian<T>(value, dest);
+    } else {
+        qToBigEndian<T>(value, dest);
+    }
+}
+
+static void putSection(QByteArray &table, int index, const MappedElf::SectionHeader &section,
+                       bool is64, bool littleEndian) {
+
+    if (is64) {
+        quint64 offset = static_cast<quint64>(index) * ELF64_SECTION_SIZE;
+
+        put<quint32>(table, offset, section.name, littleEndian);
+        put<quint32>(table, offset + 4, section.type, littleEndian);
+        put<quint64>(table, offset + 8, section.flags, littleEndian);
+        put<quint64>(table, offset + 16, section.addr, littleEndian);
+        put<quint64>(table, offset + 24, section.offset, littleEndian);
+        put<quint64>(table, offset + 32, section.size, littleEndian);
+        put<quint32>(table, offset + 40, section.link, littleEndian);
+        put<quint32>(table, offset + 44, section.info, littleEndian);
+        put<quint64>(table, offset + 48, section.addralign, littleEndian);
+        put<quint64>(table, offset + 56, section.entsize, littleEndian);
+    } else {
+        quint64 offset = static_cast<quint64>(index) * ELF32_SECTION_SIZE;
+
+        put<quint32>(table, offset, section.name, littleEndian);
+        put<quint32>(table, offset + 4, section.type, littleEndian);
+        put<quint32>(table, offset + 8, static_cast<quint32>(section.flags), littleEndian);
+        put<quint32>(table, offset + 12, static_cast<quint32>(section.addr), littleEndian);
+        put<quint32>(table, offset + 16, static_cast<quint32>(section.offset), littleEndian);
+        put<quint32>(table, offset + 20, static_cast<quint32>(section.size), littleEndian);
+        put<quint32>(table, offset + 24, section.link, littleEndian);
+        put<quint32>(table, offset + 28, section.info, littleEndian);
+        put<quint32>(table, offset + 32, static_cast<quint32>(section.addralign), littleEndian);
+        put<quint32>(table, offset + 36, static_cast<quint32>(section.entsize), littleEndian);
+    }
+}
+
+static bool isInfoIndex(const MappedElf::SectionHeader &section) {
+    return (section.flags & SHF_INFO_LINK) ||
+            section.type == SHT_REL || section.type == SHT_RELA;
+}
+
+namespace {
+
+/**
+ * @brief The ElfWriter class - sequential writer of the output file,
+ *  counts the position and the checksum of written data.
+ */
+class ElfWriter
+{
+public:
+    /**
+     * @param newOnly - if true the file is created only if it does not exist (like O_EXCL).
+     * @param hash - the hash of written data, it is not computed if it is nullptr.
+     */
+    ElfWriter(const QString& file, bool checksum, bool newOnly = false,
+              QCryptographicHash* hash = nullptr):
+        _file(file),
+        _checksum(checksum),
+        _newOnly(newOnly),
+        _hash(hash) {
+    }
+
+    bool open() {
+        _result = _file.open(QIODevice::WriteOnly |
+                             ((_newOnly)? QIODevice::NewOnly: QIODevice::Truncate));
+        return _result;
+    }
+
+    bool write(const char* data, quint64 size) {
+        if (!_result || !size) {
+            return _result;
+        }
+
+        _result = _file.write(data, static_cast<qint64>(size)) == static_cast<qint64>(size);
+
+        if (_checksum) {
+            _crc = ElfStrip::crc32(data, size, _crc);
+        }
+
+        if (_hash) {
+            _hash->addData(data, static_cast<int>(size));
+        }
+
+        _position += size;
+        return _result;
+    }
+
+    bool write(const QByteArray& data) {
+        return write(data.constData(), static_cast<quint64>(data.size()));
+    }
+
+    // writes zeros up to the offset.
+    bool fill(quint64 offset) {
+        if (offset < _position) {
+            _result = false;
+            return _result;
+        }
+
+        return write(QByteArray(static_cast<int>(offset - _position), 0));
+    }
+
+    quint32 crc() const {
+        return _crc;
+    }
+
+    bool close() {
+        _file.close();
+
+        if (!_result) {
+            _file.remove();
+        }
+
+        return _result;
+    }
+
+private:
+    QFile _file;
+    bool _checksum = false;
+    bool _newOnly = false;
+    QCryptographicHash* _hash = nullptr;
+    bool _result = false;
+    quint64 _position = 0;
+    quint32 _crc = 0;
+};
+
+}
+
+bool ElfStrip::isStripSection(const QByteArray &name) {
+    return name == ".symtab" ||
+            name == ".strtab" ||
+            name == ".comment" ||
+            name.startsWith(".debug") ||
+            name.startsWith(".zdebug");
+}
+
+quint32 ElfStrip::crc32(const char *data, quint64 size, quint32 crc) {
+    static const QVector<quint32> table = [](){
+        QVector<quint32> result(256);
+
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1)? (value >> 1) ^ 0xEDB88320u: value >> 1;
+            }
+
+            result[static_cast<int>(i)] = value;
+        }
+
+        return result;
+    }();
+
+    crc = ~crc;
+
+    for (quint64 i = 0; i < size; ++i) {
+        crc = table[static_cast<int>((crc ^ static_cast<quint8>(data[i])) & 0xFF)] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+bool ElfStrip::copyStripped(const QString &source, const QString &target,
+                            const QString &debugFile, quint64 *hash) {
+    // the existing target is not replaced, the debug file of it is kept too.
+    if (QFileInfo::exists(target)) {
+        return false;
+    }
+
+    MappedElf elf(source);
+
+    if (!elf.open() || !elf.readSections()) {
+        return false;
+    }
+
+    QByteArray debugLink;
+
+    if (debugFile.size()) {
+        quint32 crc = 0;
+
+        if (!writeDebug(elf, debugFile, crc)) {
+            return false;
+        }
+
+        // the .gnu_debuglink section: name of the debug file, padding to 4 bytes and the crc.
+        debugLink = QFileInfo(debugFile).fileName().toUtf8();
+        debugLink.append('\0');
+        debugLink.append(static_cast<int>(alignTo(static_cast<quint64>(debugLink.size()), 4)) -
+                         debugLink.size(), '\0');
+
+        int crcOffset = debugLink.size();
+        debugLink.append(4, '\0');
+        put<quint32>(debugLink, static_cast<quint64>(crcOffset), crc, elf.isLittleEndian());
+    }
+
+    QCryptographicHash sha1(QCryptographicHash::Sha1);
+
+    if (!write(elf, target, debugLink, (hash)? &sha1: nullptr)) {
+        if (debugFile.size()) {
+            QFile::remove(debugFile);
+        }
+
+        return false;
+    }
+
+    if (hash) {
+        *hash = DeployManifest::contentHash(sha1.result());
+    }
+
+    QFile::setPermissions(target, QFile::permissions(source));
+    return true;
+}
+
+bool ElfStrip::strip(const QString &file, const QString &debugFile, quint64 *hash) {
+    const QString temp = file + ".strip";
+
+    // the temp file of the previous failed strip.
+    QFile::remove(temp);
+
+    if (!copyStripped(file, temp, debugFile, hash)) {
+        return false;
+    }
+
+    // the stripped copy replaces the file by one rename, so the file is never lost if it fails.
+#ifdef Q_OS_WIN
+    bool replaced = MoveFileExW(QDir::toNativeSeparators(temp).toStdWString().c_str(),
+                                QDir::toNativeSeparators(file).toStdWString().c_str(),
+                                MOVEFILE_REPLACE_EXISTING);
+#else
+    bool replaced = ::rename(QFile::encodeName(temp).constData(),
+                             QFile::encodeName(file).constData()) == 0;
+#endif
+
+    if (!replaced) {
+        QFile::remove(temp);
+        return false;
+    }
+
+    return true;
+}
+
+bool ElfStrip::write(const MappedElf &elf, const QString &target, const QByteArray &debugLink,
+                     QCryptographicHash *hash) {
+    const auto &sections = elf.sections();
+    const int count = sections.size();
+    const bool is64 = elf.elfClass() == MappedElf::ElfClass64;
+    const bool littleEndian = elf.isLittleEndian();
+    const int namesIndex = elf.sectionNamesIndex();
+    const bool addLink = debugLink.size();
+
+    if (elf.headerSize() < ((is64)? ELF64_HEADER_SIZE: ELF32_HEADER_SIZE)) {
+        return false;
+    }
+
+    QVector<bool> removed(count, false);
+
+    for (int i = 1; i < count; ++i) {
+        if (sections[i].flags & SHF_ALLOC) {
+            continue;
+        }
+
+        const auto name = elf.sectionName(i);
+
+        // the old link is replaced by the link to new debug file.
+        if (isStripSection(name) || (addLink && name == DEBUG_LINK_NAME)) {
+            removed[i] = true;
+        }
+    }
+
+    // relocations of removed sections (for example .rela.debug_info).
+    for (int i = 1; i < count; ++i) {
+        const auto &section = sections[i];
+        if (!(section.flags & SHF_ALLOC) &&
+                (section.type == SHT_REL || section.type == SHT_RELA) &&
+                section.info < static_cast<quint32>(count) && removed[section.info]) {
+            removed[i] = true;
+        }
+    }
+
+    if (removed[namesIndex]) {
+        return false;
+    }
+
+    // the st_shndx of the dynamic symbols points to the allocated sections,
+    // so the indexes of them can not be changed without the rewriting of the .dynsym section.
+    QVector<int> indexes(count, -1);
+    int newCount = 0;
+    bool shifted = false;
+
+    for (int i = 0; i < count; ++i) {
+        if (removed[i]) {
+            shifted = true;
+            continue;
+        }
+
+        if (shifted && (sections[i].flags & SHF_ALLOC)) {
+            return false;
+        }
+
+        indexes[i] = newCount++;
+    }
+
+    auto isLinked = [count, &removed](quint32 index) {
+        return index < static_cast<quint32>(count) && removed[index];
+    };
+
+    for (int i = 0; i < count; ++i) {
+        const auto &section = sections[i];
+
+        if (!removed[i] && (isLinked(section.link) || (isInfoIndex(section) && isLinked(section.info)))) {
+            return false;
+        }
+    }
+
+    // the loadable part of file is written as is.
+    // the sums of the offsets and the sizes are computed only after the range checks,
+    // so the broken fields can not wrap them.
+    if (!elf.containsRange(elf.programHeadersOffset(), elf.programHeadersSize())) {
+        return false;
+    }
+
+    quint64 loadEnd = qMax<quint64>(elf.headerSize(),
+                                    elf.programHeadersOffset() + elf.programHeadersSize());
+
+    for (const auto &header: elf.programHeaders()) {
+        if (!elf.containsRange(header.offset, header.filesz)) {
+            return false;
+        }
+
+        loadEnd = qMax(loadEnd, header.offset + header.filesz);
+    }
+
+    auto data = reinterpret_cast<const char*>(elf.data());
+    QVector<MappedElf::SectionHeader> result = sections;
+    QVector<bool> moved(count, false);
+
+    // the names of sections are extended by the name of debug link section.
+    QByteArray names;
+    quint32 linkName = 0;
+
+    if (addLink) {
+        const auto &section = sections[namesIndex];
+
+        // the names table inside the loadable part can not be extended.
+        if (!elf.containsRange(section.offset, section.size) ||
+                section.offset + section.size <= loadEnd) {
+            return false;
+        }
+
+        names = QByteArray(data + section.offset, static_cast<int>(section.size));
+
+        // the name can be shared with the old link section (or be the suffix of other name).
+        const QByteArray name(DEBUG_LINK_NAME, sizeof(DEBUG_LINK_NAME));
+        int index = names.indexOf(name);
+
+        if (index < 0) {
+            if (!names.endsWith('\0')) {
+                names.append('\0');
+            }
+
+            index = names.size();
+            names.append(name);
+        }
+
+        linkName = static_cast<quint32>(index);
+
+        result[namesIndex].size = static_cast<quint64>(names.size());
+    }
+
+    quint64 end = loadEnd;
+
+    for (int i = 0; i < count; ++i) {
+        const auto &section = sections[i];
+
+        if (removed[i]) {
+            continue;
+        }
+
+        if (section.type == SHT_NULL || section.type == SHT_NOBITS) {
+            result[i].offset = qMin(section.offset, loadEnd);
+            continue;
+        }
+
+        if (!elf.containsRange(section.offset, section.size) || section.addralign > elf.size()) {
+            return false;
+        }
+
+        if (section.offset + section.size <= loadEnd) {
+            continue;
+        }
+
+        if (section.offset < loadEnd) {
+            return false;
+        }
+
+        end = alignTo(end, section.addralign);
+        result[i].offset = end;
+        moved[i] = true;
+        end += result[i].size;
+    }
+
+    MappedElf::SectionHeader link;
+
+    if (addLink) {
+        end = alignTo(end, 4);
+
+        link.name = linkName;
+        link.type = SHT_PROGBITS;
+        link.offset = end;
+        link.size = static_cast<quint64>(debugLink.size());
+        link.addralign = 4;
+
+        end += link.size;
+    }
+
+    const quint64 sectionsOffset = alignTo(end, (is64)? 8: 4);
+    const int entrySize = (is64)? ELF64_SECTION_SIZE: ELF32_SECTION_SIZE;
+    const int tableCount = newCount + ((addLink)? 1: 0);
+
+    QByteArray header(data, elf.headerSize());
+
+    if (is64) {
+        put<quint64>(header, 40, sectionsOffset, littleEndian);
+        put<quint16>(header, 58, static_cast<quint16>(entrySize), littleEndian);
+        put<quint16>(header, 60, static_cast<quint16>(tableCount), littleEndian);
+        put<quint16>(header, 62, static_cast<quint16>(indexes[namesIndex]), littleEndian);
+    } else {
+        put<quint32>(header, 32, static_cast<quint32>(sectionsOffset), littleEndian);
+        put<quint16>(header, 46, static_cast<quint16>(entrySize), littleEndian);
+        put<quint16>(header, 48, static_cast<quint16>(tableCount), littleEndian);
+        put<quint16>(header, 50, static_cast<quint16>(indexes[namesIndex]), littleEndian);
+    }
+
+    QByteArray table(tableCount * entrySize, 0);
+
+    for (int i = 0; i < count; ++i) {
+        if (removed[i]) {
+            continue;
+        }
+
+        auto &section = result[i];
+
+        if (section.link < static_cast<quint32>(count) && section.link) {
+            section.link = static_cast<quint32>(indexes[section.link]);
+        }
+
+        if (isInfoIndex(section) && section.info < static_cast<quint32>(count) && section.info) {
+            section.info = static_cast<quint32>(indexes[section.info]);
+        }
+
+        putSection(table, indexes[i], section, is64, littleEndian);
+    }
+
+    if (addLink) {
+        putSection(table, newCount, link, is64, littleEndian);
+    }
+
+    ElfWriter writer(target, false, true, hash);
+
+    if (!writer.open()) {
+        return false;
+    }
+
+    writer.write(header);
+    writer.write(data + elf.headerSize(), loadEnd - elf.headerSize());
+
+    for (int i = 0; i < count; ++i) {
+        if (!moved[i]) {
+            continue;
+        }
+
+        writer.fill(result[i].offset);
+
+        if (i == namesIndex && addLink) {
+            writer.write(names);
+        } else {
+            writer.write(data + sections[i].offset, sections[i].size);
+        }
+    }
+
+    if (addLink) {
+        writer.fill(link.offset);
+        writer.write(debugLink);
+    }
+
+    writer.fill(sectionsOffset);
+    writer.write(table);
+
+    return writer.close();
+}
+
+bool ElfStrip::writeDebug(const MappedElf &elf, const QString &target, quint32 &crc) {
+    const auto &sections = elf.sections();
+    const int count = sections.size();
+    const bool is64 = elf.elfClass() == MappedElf::ElfClass64;
+    const bool littleEndian = elf.isLittleEndian();
+
+    if (elf.headerSize() < ((is64)? ELF64_HEADER_SIZE: ELF32_HEADER_SIZE)) {
+        return false;
+    }
+
+    // the debug file keeps all sections with same indexes, but the allocated sections
+    // (except notes with the build id) have no data, like objcopy --only-keep-debug does.
+    auto data = reinterpret_cast<const char*>(elf.data());
+    QVector<MappedElf::SectionHeader> result = sections;
+    QVector<bool> hasData(count, false);
+    quint64 end = elf.headerSize();
+
+    for (int i = 1; i < count; ++i) {
+        auto &section = result[i];
+
+        if (section.type == SHT_NULL) {
+            continue;
+        }
+
+        if ((section.flags & SHF_ALLOC) && section.type != SHT_NOTE) {
+            section.type = SHT_NOBITS;
+        }
+
+        if (section.type == SHT_NOBITS) {
+            section.offset = end;
+            continue;
+        }
+
+        if (!elf.containsRange(section.offset, section.size) || section.addralign > elf.size()) {
+            return false;
+        }
+
+        end = alignTo(end, section.addralign);
+        section.offset = end;
+        hasData[i] = true;
+        end += section.size;
+    }
+
+    const quint64 sectionsOffset = alignTo(end, (is64)? 8: 4);
+    const int entrySize = (is64)? ELF64_SECTION_SIZE: ELF32_SECTION_SIZE;
+
+    // the debug file has no program headers.
+    QByteArray header(data, elf.headerSize());
+
+    if (is64) {
+        put<quint64>(header, 32, 0, littleEndian);
+        put<quint64>(header, 40, sectionsOffset, littleEndian);
+        put<quint16>(header, 56, 0, littleEndian);
+        put<quint16>(header, 58, static_cast<quint16>(entrySize), littleEndian);
+        put<quint16>(header, 60, static_cast<quint16>(count), littleEndian);
+    } else {
+        put<quint32>(header, 28, 0, littleEndian);
+        put<quint32>(header, 32, static_cast<quint32>(sectionsOffset), littleEndian);
+        put<quint16>(header, 44, 0, littleEndian);
+        put<quint16>(header, 46, static_cast<quint16>(entrySize), littleEndian);
+        put<quint16>(header, 48, static_cast<quint16>(count), littleEndian);
+    }
+
+    QByteArray table(count * entrySize, 0);
+
+    for (int i = 1; i < count; ++i) {
+        putSection(table, i, result[i], is64, littleEndian);
+    }
+
+    ElfWriter writer(target, true);
+
+    if (!writer.open()) {
+        return false;
+    }
+
+    writer.write(header);
+
+    for (int i = 1; i < count; ++i) {
+        if (!hasData[i]) {
+            continue;
+        }
+
+        writer.fill(result[i].offset);
+        writer.write(data + sections[i].offset, sections[i].size);
+    }
+
+    writer.fill(sectionsOffset);
+    writer.write(table);
+
+    crc = writer.crc();
+    return writer.close();
+}
@@ -0,0 +1,67 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef ELFSTRIP_H
+#define ELFSTRIP_H
+
+#include <QByteArray>
+#include <QString>
+#include "deploy_global.h"
+
+class QCryptographicHash;
+
+class MappedElf;
+
+/**
+ * @brief The ElfStrip class - in-process strip of ELF files.
+ * Removes the not allocated .symtab, .strtab, .comment and .debug_* sections (and relocations of them).
+ * The loadable part of file is written as is, the kept not allocated sections are moved
+ * after it and the section header table is written at the end of file.
+ * Files that can not be stripped without the rewriting of the loadable part are not supported.
+ *
+ * The removed sections can be saved into the separate debug file (like objcopy --only-keep-debug does),
+ * in this case the stripped file gets the .gnu_debuglink section with name and checksum of debug file.
+ */
+class DEPLOYSHARED_EXPORT ElfStrip
+{
+public:
+    /**
+     * @brief copyStripped - write stripped copy of source into target.
+     *  The copy and the strip are done by one pass over the source data.
+     * @param debugFile - path of the debug file, if it is empty then the debug info is dropped.
+     * @param hash - the content hash of the written target (see DeployManifest::contentHash).
+     * @return false if source is not supported ELF file, target already exists or can not be written.
+     */
+    static bool copyStripped(const QString& source, const QString& target,
+                             const QString& debugFile = QString(), quint64* hash = nullptr);
+
+    /**
+     * @brief strip - strip file in place.
+     * @param debugFile - path of the debug file, if it is empty then the debug info is dropped.
+     * @param hash - the content hash of the stripped file.
+     */
+    static bool strip(const QString& file, const QString& debugFile = QString(), quint64* hash = nullptr);
+
+    /**
+     * @brief isStripSection
+     * @return true if the not allocated section with name is removed by strip.
+     */
+    static bool isStripSection(const QByteArray& name);
+
+    /**
+     * @brief crc32 - the checksum of the .gnu_debuglink section.
+     * @param crc - checksum of previous data
+     */
+    static quint32 crc32(const char* data, quint64 size, quint32 crc = 0);
+
+private:
+    static bool write(const MappedElf& elf, const QString& target, const QByteArray& debugLink,
+                      QCryptographicHash* hash);
+    static bool writeDebug(const MappedElf& elf, const QString& target, quint32& crc);
+};
+
+#endif // ELFSTRIP_H
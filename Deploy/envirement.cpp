@@ -74,6 +74,10 @@ void Envirement::addEnv(const QStringList &listDirs) {
     }
 }
 
+bool Envirement::isIgnored(const QString &dir) const {
+    return _ignoreEnvList && _ignoreEnvList->inThisEnvirement(dir);
+}
+
 bool Envirement::inThisEnvirement(const QString &file) const {
     QFileInfo info (file);
 
@@ -33,6 +33,9 @@ public:
     void addEnv(const QString &dir);
     void addEnv(const QStringList &listDirs);
 
+    // return true if dir is in the ignore list of this envirement
+    bool isIgnored(const QString &dir) const;
+
     // return true if file exits in this envirement
     bool inThisEnvirement(const QString &file) const;
 
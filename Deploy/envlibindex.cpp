@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "envlibindex.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+#include <cstring>
+
+#define ENV_INDEX_MAGIC   0x4351454C // CQEL
+#define ENV_INDEX_VERSION 1
+
+// bits of the bloom filter per one name and count of hash functions.
+#define BLOOM_BITS_PER_NAME 10
+#define BLOOM_HASHES        3
+
+static quint64 fnv1a(const char* data, int size) {
+    quint64 hash = 14695981039346656037ULL;
+
+    for (int i = 0; i < size; ++i) {
+        hash ^= static_cast<quint8>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+template <class T>
+static QByteArray toRaw(const QVector<T>& vector) {
+    return QByteArray(reinterpret_cast<const char*>(vector.constData()),
+                      vector.size() * static_cast<int>(sizeof(T)));
+}
+
+template <class T>
+static bool fromRaw(const QByteArray& raw, QVector<T>& vector) {
+    if (raw.size() % static_cast<int>(sizeof(T))) {
+        return false;
+    }
+
+    vector.resize(raw.size() / static_cast<int>(sizeof(T)));
+    memcpy(vector.data(), raw.constData(), static_cast<size_t>(raw.size()));
+
+    return true;
+}
+
+EnvLibIndex::EnvLibIndex() {
+
+}
+
+quint32 EnvLibIndex::intern(const QByteArray &str, QHash<QByteArray, quint32> &pool) {
+    auto it = pool.constFind(str);
+    if (it != pool.constEnd()) {
+        return *it;
+    }
+
+    auto offset = static_cast<quint32>(_pool.size());
+    _pool.append(str);
+    _pool.append('\0');
+    pool.insert(str, offset);
+
+    return offset;
+}
+
+const char *EnvLibIndex::str(quint32 offset) const {
+    return _pool.constData() + offset;
+}
+
+void EnvLibIndex::build(const QStringList &dirs, const QStringList &masks) {
+    clear();
+
+    _dirs = uniqueDirs(dirs);
+    _fingerprint = makeFingerprint(_dirs);
+
+    QHash<QByteArray, quint32> pool;
+    QDir dir;
+
+    for (int i = 0; i < _dirs.size(); ++i) {
+        dir.setPath(_dirs[i]);
+
+        auto list = dir.entryList(masks, QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden);
+
+        for (const auto &file: list) {
+            Entry entry;
+            entry.name = intern(file.toUpper().toUtf8(), pool);
+            entry.file = intern(file.toUtf8(), pool);
+            entry.dir = static_cast<quint32>(i);
+            _entries.push_back(entry);
+        }
+    }
+
+    // the stable sort keeps order of dirs inside of the bucket.
+    std::stable_sort(_entries.begin(), _entries.end(), [this](const Entry& left, const Entry& right) {
+        return strcmp(str(left.name), str(right.name)) < 0;
+    });
+
+    for (int i = 0; i < _entries.size(); ++i) {
+        if (_buckets.size() && _buckets.last().name == _entries[i].name) {
+            _buckets.last().count++;
+            continue;
+        }
+
+        Bucket bucket;
+        bucket.name = _entries[i].name;
+        bucket.first = static_cast<quint32>(i);
+        bucket.count = 1;
+        _buckets.push_back(bucket);
+    }
+
+    buildBloom();
+}
+
+void EnvLibIndex::buildBloom() {
+    int words = std::max(1, (_buckets.size() * BLOOM_BITS_PER_NAME + 63) / 64);
+    _bloom.fill(0, words);
+
+    const quint64 bits = static_cast<quint64>(words) * 64;
+
+    for (const auto &bucket: _buckets) {
+        const char* name = str(bucket.name);
+        quint64 hash = fnv1a(name, static_cast<int>(strlen(name)));
+        quint64 h1 = hash & 0xFFFFFFFF, h2 = hash >> 32;
+
+        for (quint64 i = 0; i < BLOOM_HASHES; ++i) {
+            quint64 bit = (h1 + i * h2) % bits;
+            _bloom[static_cast<int>(bit / 64)] |= (1ULL << (bit % 64));
+        }
+    }
+}
+
+bool EnvLibIndex::mayContain(const QByteArray &upperName) const {
+    if (_bloom.isEmpty()) {
+        return false;
+    }
+
+    const quint64 bits = static_cast<quint64>(_bloom.size()) * 64;
+    quint64 hash = fnv1a(upperName.constData(), upperName.size());
+    quint64 h1 = hash & 0xFFFFFFFF, h2 = hash >> 32;
+
+    for (quint64 i = 0; i < BLOOM_HASHES; ++i) {
+        quint64 bit = (h1 + i * h2) % bits;
+        if (!(_bloom[static_cast<int>(bit / 64)] & (1ULL << (bit % 64)))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const EnvLibIndex::Bucket *EnvLibIndex::findBucket(const QByteArray &upperName) const {
+    if (!mayContain(upperName)) {
+        return nullptr;
+    }
+
+    auto it = std::lower_bound(_buckets.begin(), _buckets.end(), upperName,
+                               [this](const Bucket& bucket, const QByteArray& name) {
+        return strcmp(str(bucket.name), name.constData()) < 0;
+    });
+
+    if (it == _buckets.end() || strcmp(str(it->name), upperName.constData()) != 0) {
+        return nullptr;
+    }
+
+    return &(*it);
+}
+
+QStringList EnvLibIndex::find(const QString &upperName) const {
+    QStringList result;
+
+    auto bucket = findBucket(upperName.toUtf8());
+    if (!bucket) {
+        return result;
+    }
+
+    result.reserve(static_cast<int>(bucket->count));
+    for (quint32 i = bucket->first; i < bucket->first + bucket->count; ++i) {
+        const auto &entry = _entries[static_cast<int>(i)];
+        result.push_back(_dirs[static_cast<int>(entry.dir)] + "/" + QString::fromUtf8(str(entry.file)));
+    }
+
+    return result;
+}
+
+QStringList EnvLibIndex::names() const {
+    QStringList result;
+    result.reserve(_buckets.size());
+
+    for (const auto &bucket: _buckets) {
+        result.push_back(QString::fromUtf8(str(bucket.name)));
+    }
+
+    return result;
+}
+
+int EnvLibIndex::size() const {
+    return _entries.size();
+}
+
+void EnvLibIndex::clear() {
+    _pool.clear();
+    _entries.clear();
+    _buckets.clear();
+    _bloom.clear();
+    _dirs.clear();
+    _fingerprint.clear();
+}
+
+const QByteArray &EnvLibIndex::fingerprint() const {
+    return _fingerprint;
+}
+
+QStringList EnvLibIndex::uniqueDirs(const QStringList &dirs) {
+    // the order of dirs is the order of searching, so only the later duplicates are removed.
+    QStringList result;
+    QSet<QString> seen;
+
+    for (const auto &dir: dirs) {
+        if (!seen.contains(dir)) {
+            seen.insert(dir);
+            result.push_back(dir);
+        }
+    }
+
+    return result;
+}
+
+QByteArray EnvLibIndex::makeFingerprint(const QStringList &dirs) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    for (const auto &dir: uniqueDirs(dirs)) {
+        hash.addData(dir.toUtf8());
+        hash.addData(QByteArray::number(QFileInfo(dir).lastModified().toMSecsSinceEpoch()));
+    }
+
+    return hash.result();
+}
+
+bool EnvLibIndex::isValidData() const {
+    const auto poolSize = static_cast<quint32>(_pool.size());
+
+    if (poolSize && _pool.at(_pool.size() - 1) != '\0') {
+        return false;
+    }
+
+    for (const auto &entry: _entries) {
+        if (entry.name >= poolSize || entry.file >= poolSize ||
+                entry.dir >= static_cast<quint32>(_dirs.size())) {
+            return false;
+        }
+    }
+
+    const auto entries = static_cast<quint32>(_entries.size());
+    for (const auto &bucket: _buckets) {
+        if (bucket.name >= poolSize || bucket.first + bucket.count > entries) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool EnvLibIndex::load(const QString &file, const QByteArray &fingerprint) {
+    clear();
+
+    QFile index(file);
+
+    if (!index.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&index);
+
+    quint32 magic, version;
+    stream >> magic >> version;
+
+    if (magic != ENV_INDEX_MAGIC || version != ENV_INDEX_VERSION) {
+        return false;
+    }
+
+    QByteArray savedFingerprint, entries, buckets, bloom;
+    stream >> savedFingerprint;
+
+    if (savedFingerprint != fingerprint) {
+        return false;
+    }
+
+    stream >> _dirs >> _pool >> entries >> buckets >> bloom;
+
+    if (stream.status() != QDataStream::Ok ||
+            !fromRaw(entries, _entries) ||
+            !fromRaw(buckets, _buckets) ||
+            !fromRaw(bloom, _bloom) ||
+            !isValidData()) {
+        clear();
+        return false;
+    }
+
+    _fingerprint = savedFingerprint;
+
+    return true;
+}
+
+bool EnvLibIndex::save(const QString &file) const {
+    QDir().mkpath(QFileInfo(file).absolutePath());
+
+    QFile index(file);
+
+    if (!index.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QDataStream stream(&index);
+    stream << static_cast<quint32>(ENV_INDEX_MAGIC)
+           << static_cast<quint32>(ENV_INDEX_VERSION)
+           << _fingerprint
+           << _dirs
+           << _pool
+           << toRaw(_entries)
+           << toRaw(_buckets)
+           << toRaw(_bloom);
+
+    return stream.status() == QDataStream::Ok;
+}
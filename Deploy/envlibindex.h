@@ -0,0 +1,99 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef ENVLIBINDEX_H
+#define ENVLIBINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include "deploy_global.h"
+
+/**
+ * @brief The EnvLibIndex class - index of all libraries of the environment dirs.
+ * All names are stored in one string pool. The entries are sorted by upper name of library,
+ * so all libraries with same name are one bucket and lookup is a binary search over buckets.
+ * The bloom filter rejects most of the names that are not in the index without the search.
+ * The index can be saved into file and loaded while the environment dirs are not changed.
+ */
+class DEPLOYSHARED_EXPORT EnvLibIndex
+{
+public:
+    struct Entry {
+        quint32 name = 0;
+        quint32 file = 0;
+        quint32 dir = 0;
+    };
+
+    struct Bucket {
+        quint32 name = 0;
+        quint32 first = 0;
+        quint32 count = 0;
+    };
+
+    EnvLibIndex();
+
+    /**
+     * @brief build - list all dirs and create the index.
+     * @param dirs - environment dirs
+     * @param masks - name filters of libraries
+     */
+    void build(const QStringList& dirs, const QStringList& masks);
+
+    /**
+     * @brief find
+     * @param upperName - upper name of library
+     * @return full paths of all libraries with this name.
+     */
+    QStringList find(const QString& upperName) const;
+
+    /**
+     * @brief mayContain - check the bloom filter.
+     * @return false if upperName is not in the index exactly.
+     */
+    bool mayContain(const QByteArray& upperName) const;
+
+    /**
+     * @brief names - list of upper names of all libraries.
+     */
+    QStringList names() const;
+
+    int size() const;
+    void clear();
+
+    /**
+     * @brief fingerprint - sha1 of the dirs (in order of searching) and the modification time of each dir.
+     */
+    const QByteArray& fingerprint() const;
+    static QByteArray makeFingerprint(const QStringList& dirs);
+
+    /**
+     * @brief load - load index from file.
+     * @param fingerprint - expected fingerprint of environment.
+     * @return true if file is valid index of the same environment.
+     */
+    bool load(const QString& file, const QByteArray& fingerprint);
+    bool save(const QString& file) const;
+
+private:
+    quint32 intern(const QByteArray& str, QHash<QByteArray, quint32>& pool);
+    const char* str(quint32 offset) const;
+    const Bucket* findBucket(const QByteArray& upperName) const;
+    void buildBloom();
+    static QStringList uniqueDirs(const QStringList& dirs);
+    bool isValidData() const;
+
+    QByteArray _pool;
+    QVector<Entry> _entries;
+    QVector<Bucket> _buckets;
+    QVector<quint64> _bloom;
+    QStringList _dirs;
+    QByteArray _fingerprint;
+};
+
+#endif // ENVLIBINDEX_H
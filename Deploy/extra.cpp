@@ -10,11 +10,13 @@ QSet<QString> Extra::getExtraPathsMasks() const {
 }
 
 void Extra::setExtraPathsMasks(const QSet<QString> &value) {
-    extraPathsMasks = upper(value);
+    extraPathsMasks.clear();
+    pathsMasksMatcher.clear();
+    addMasks(upper(value), extraPathsMasks, pathsMasksMatcher);
 }
 
 void Extra::addExtraPathsMasks(const QSet<QString> &value) {
-    extraPathsMasks += upper(value);
+    addMasks(upper(value), extraPathsMasks, pathsMasksMatcher);
 }
 
 QSet<QString> Extra::getExtraNamesMasks() const {
@@ -22,11 +24,13 @@ QSet<QString> Extra::getExtraNamesMasks() const {
 }
 
 void Extra::setExtraNamesMasks(const QSet<QString> &value) {
-    extraNamesMasks = upper(value);
+    extraNamesMasks.clear();
+    namesMasksMatcher.clear();
+    addMasks(upper(value), extraNamesMasks, namesMasksMatcher);
 }
 
 void Extra::addtExtraNamesMasks(const QSet<QString> &value) {
-    extraNamesMasks += upper(value);
+    addMasks(upper(value), extraNamesMasks, namesMasksMatcher);
 }
 
 QSet<QString> Extra::upper(const QSet<QString>& set) const {
@@ -37,6 +41,15 @@ QSet<QString> Extra::upper(const QSet<QString>& set) const {
     return res;
 }
 
+void Extra::addMasks(const QSet<QString> &value, QSet<QString> &masks, PathMatcher &matcher) {
+    for (const auto &mask : value) {
+        if (!masks.contains(mask)) {
+            masks.insert(mask);
+            matcher.addPattern(mask);
+        }
+    }
+}
+
 QSet<QString> Extra::getExtraPaths() const {
     return extraPaths;
 }
@@ -56,17 +69,7 @@ bool Extra::contains(const QString &path) const {
         return true;
     }
 
-    for (auto i: extraPathsMasks) {
-        if (PathUtils::fixPath(info.absoluteFilePath()).contains(i)) {
-            return true;
-        }
-    }
-
-    for (auto i: extraNamesMasks) {
-        if (PathUtils::fixPath(info.fileName()).contains(i)) {
-            return true;
-        }
-    }
-
-    return false;
+    // the absolute path is already clean, the masks are matched without the fixPath of path.
+    return pathsMasksMatcher.match(info.absoluteFilePath()) ||
+            namesMasksMatcher.match(info.fileName());
 }
@@ -1,6 +1,7 @@
 #ifndef EXTRA_H
 #define EXTRA_H
 #include "deploy_global.h"
+#include "pathmatcher.h"
 
 #include <QSet>
 
@@ -10,8 +11,16 @@ class DEPLOYSHARED_EXPORT Extra {
     QSet<QString> extraPathsMasks;
     QSet<QString> extraNamesMasks;
 
+    PathMatcher pathsMasksMatcher{ONLY_WIN_CASE_INSENSIATIVE};
+    PathMatcher namesMasksMatcher{ONLY_WIN_CASE_INSENSIATIVE};
+
     QSet<QString> upper(const QSet<QString> & ) const;
 
+    /**
+     * @brief addMasks - add only the new masks into the matcher, it is compiled at the first match.
+     */
+    static void addMasks(const QSet<QString>& value, QSet<QString>& masks, PathMatcher& matcher);
+
 public:
     QSet<QString> getExtraPaths() const;
     void setExtraPaths(const QSet<QString> &value);
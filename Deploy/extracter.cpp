@@ -26,6 +26,9 @@
 
 #include <fstream>
 
+// count of copied qml files that are scanned at once by -allQmlDependes.
+#define QML_SCAN_BATCH_SIZE 256
+
 bool Extracter::deployMSVC() {
     qInfo () << "try deploy msvc";
     auto msvcInstaller = DeployCore::getVCredist(DeployCore::_config->qtDir.getBins());
@@ -75,9 +78,8 @@ bool Extracter::extractWebEngine() {
     return true;
 }
 
-bool Extracter::copyPlugin(const QString &plugin, const QString& package) {
-
-    QStringList listItems;
+bool Extracter::copyPlugin(const QString &plugin, const QString& package,
+                           QStringList *copiedItems) {
 
     auto cnf = DeployCore::_config;
     auto targetPath = cnf->getTargetDir() + "/" + package;
@@ -88,18 +90,14 @@ bool Extracter::copyPlugin(const QString &plugin, const QString& package) {
             QFileInfo(plugin).fileName();
 
     if (!_fileManager->copyFolder(plugin, pluginPath,
-                    QStringList() << ".so.debug" << "d.dll", &listItems)) {
+                    QStringList() << ".so.debug" << "d.dll", copiedItems)) {
         return false;
     }
 
-    for (const auto &item : listItems) {
-        extractPluginLib(item, package);
-    }
-
     return true;
 }
 
-void Extracter::copyExtraPlugins(const QString& package) {
+void Extracter::copyExtraPlugins(const QString& package, QStringList *copiedItems) {
     QFileInfo info;
 
     auto cnf = DeployCore::_config;
@@ -114,24 +112,30 @@ void Extracter::copyExtraPlugins(const QString& package) {
 
         info.setFile(extraPlugin);
         if (info.isDir() && DeployCore::_config->qtDir.isQt(info.absoluteFilePath())) {
-            copyPlugin(info.absoluteFilePath(), package);
+            copyPlugin(info.absoluteFilePath(), package, copiedItems);
 
         } else if (info.exists()) {
             _fileManager->copyFile(info.absoluteFilePath(),
                                   targetPath + distro.getPluginsOutDir());
 
-            extractPluginLib(info.absoluteFilePath(), package);
+            copiedItems->push_back(info.absoluteFilePath());
         }
     }
 }
 
 void Extracter::copyPlugins(const QStringList &list, const QString& package) {
+    QStringList copiedItems;
+
     for (const auto &plugin : list) {
-        if (!copyPlugin(plugin, package)) {
+        if (!copyPlugin(plugin, package, &copiedItems)) {
             qWarning() << plugin << " not copied!";
         }
     }
-    copyExtraPlugins(package);
+    copyExtraPlugins(package, &copiedItems);
+
+    // the copied plugins are scanned, so all copies should be finished.
+    _fileManager->waitForCopies(&copiedItems);
+    extractPluginLibs(copiedItems, package);
 }
 
 void Extracter::extractAllTargets() {
@@ -139,9 +143,7 @@ void Extracter::extractAllTargets() {
     for (auto i = cfg->packages().cbegin(); i != cfg->packages().cend(); ++i) {
         _packageDependencyes[i.key()] = {};
 
-        for (const auto &target : i.value().targets()) {
-            extract(target, &_packageDependencyes[i.key()]);
-        }
+        extract(i.value().targets().values(), &_packageDependencyes[i.key()]);
     }
 }
 
@@ -190,10 +192,6 @@ void Extracter::copyFiles() {
         if (QuasarAppUtils::Params::isEndable("deploySystem")) {
             copyLibs(_packageDependencyes[i.key()].systemLibs(), i.key());
         }
-
-        if (!QuasarAppUtils::Params::isEndable("noStrip") && !_fileManager->strip(cnf->getTargetDir())) {
-            QuasarAppUtils::Params::verboseLog("strip failed!");
-        }
     }
 }
 
@@ -240,6 +238,16 @@ void Extracter::deploy() {
         QuasarAppUtils::Params::verboseLog("deploy msvc failed");
     }
 
+    if (!_fileManager->waitForCopies()) {
+        QuasarAppUtils::Params::verboseLog("some files not copied", QuasarAppUtils::Error);
+    }
+
+    _fileManager->printCopyStatistic();
+
+    if (!QuasarAppUtils::Params::isEndable("noStrip") && !_fileManager->stripDeployed()) {
+        QuasarAppUtils::Params::verboseLog("strip failed!");
+    }
+
     _metaFileManager->createRunMetaFiles();
 
     qInfo() << "deploy done!";
@@ -301,17 +309,19 @@ QFileInfoList Extracter::findFilesInsideDir(const QString &name,
     return files;
 }
 
-void Extracter::extractLib(const QString &file,
-                           DependencyMap* depMap,
-                           const QString& mask) {
+void Extracter::extractLibs(const QStringList &files,
+                            DependencyMap* depMap,
+                            const QString& mask) {
 
     assert(depMap);
 
-    qInfo() << "extract lib :" << file;
+    for (const auto &file: files) {
+        qInfo() << "extract lib :" << file;
+    }
 
-    auto data = _scaner->scan(file);
+    auto data = _scaner->scanMany(files);
 
-    for (const auto &line : data) {
+    for (const auto &line : data.libs()) {
 
         if (mask.size() && !line.getName().contains(mask, ONLY_WIN_CASE_INSENSIATIVE)) {
             continue;
@@ -333,11 +343,11 @@ void Extracter::extractLib(const QString &file,
     }
 }
 
-void Extracter::extractPluginLib(const QString& item, const QString& package) {
+void Extracter::extractPluginLibs(const QStringList& items, const QString& package) {
     if (QuasarAppUtils::Params::isEndable("extractPlugins")) {
-        extract(item, &_packageDependencyes[package]);
+        extract(items, &_packageDependencyes[package]);
     } else {
-        extract(item, &_packageDependencyes[package], "Qt");
+        extract(items, &_packageDependencyes[package], "Qt");
     }
 }
 
@@ -349,24 +359,116 @@ bool Extracter::extractQmlAll() {
     }
 
     auto cnf = DeployCore::_config;
+    const QStringList filter = QStringList() << ".so.debug" << "d.dll" << ".pdb";
 
+    int scannedFiles = 0;
 
     for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
         auto targetPath = cnf->getTargetDir() + "/" + i.key();
         auto distro = cnf->getDistroFromPackage(i.key());
+        const auto qmlOut = targetPath + distro.getQmlOutDir();
 
+        // the copied files are scanned by batches, the size of batch is checked after each plugin dir.
+        // The scanner keeps the graph of the previous batches, so the libraries that are already
+        // in the package map are not resolved again.
         QStringList listItems;
 
-        if (!_fileManager->copyFolder(cnf->qtDir.getQmls(), targetPath + distro.getQmlOutDir(),
-                        QStringList() << ".so.debug" << "d.dll" << ".pdb",
-                        &listItems)) {
-            return false;
+        auto scanBatch = [this, &listItems, &scannedFiles, &i]() {
+            _fileManager->waitForCopies(&listItems);
+            extractPluginLibs(listItems, i.key());
+            scannedFiles += listItems.size();
+            listItems.clear();
+        };
+
+        QList<QPair<QString, QString>> dirs = {{cnf->qtDir.getQmls(), qmlOut}};
+
+        while (dirs.size()) {
+            const auto dir = dirs.takeLast();
+
+            if (!_fileManager->copyFolder(dir.first, dir.second, filter, &listItems, nullptr, false)) {
+                return false;
+            }
+
+            if (listItems.size() >= QML_SCAN_BATCH_SIZE) {
+                scanBatch();
+            }
+
+            const auto subDirs = QDir(dir.first).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+            for (const auto &subDir: subDirs) {
+                dirs.push_back({subDir.absoluteFilePath(), dir.second + "/" + subDir.fileName()});
+            }
         }
 
-        for (const auto &item : listItems) {
-            extractPluginLib(item, i.key());
+        scanBatch();
+    }
+
+    auto peak = DeployCore::peakMemoryUsage();
+    qInfo() << QString("Qml scan statistic: %0 files scanned, peak memory %1").
+               arg(scannedFiles).
+               arg((peak < 0)? QString("unknown"):
+                               QString::number(static_cast<double>(peak) / (1024 * 1024), 'f', 1) + " MB");
+
+    return true;
+}
+
+void Extracter::prepareQmlIndex() {
+    const auto qmlRoot = DeployCore::_config->qtDir.getQmls();
+
+    if (_qmlIndex.size() && _qmlIndex.qmlRoot() == QFileInfo(qmlRoot).absoluteFilePath()) {
+        return;
+    }
+
+    const QString indexFile = QmlModuleIndex::indexFile(qmlRoot);
+
+    if (QuasarAppUtils::Params::isEndable("clearCache") ||
+            !_qmlIndex.load(indexFile, QmlModuleIndex::makeFingerprint(qmlRoot))) {
+
+        _qmlIndex.build(qmlRoot);
+
+        if (!_qmlIndex.save(indexFile)) {
+            QuasarAppUtils::Params::verboseLog("Failed to save the qml modules index into " + indexFile,
+                                               QuasarAppUtils::Warning);
         }
+    }
+
+    QuasarAppUtils::Params::verboseLog("qml modules index contains " +
+                                       QString::number(_qmlIndex.size()) + " modules");
+}
 
+bool Extracter::copyQmlModules(QStringList modules, const QString &target,
+                               const QStringList &filter, QStringList *copiedItems) {
+
+    const QDir qmlRoot(DeployCore::_config->qtDir.getQmls());
+
+    // the nested module dir is copied with the parent module dir,
+    // the dirs are sorted with the end slash so the nested dirs follow the parent dir.
+    for (auto &module: modules) {
+        module += "/";
+    }
+
+    modules.sort();
+    modules.removeDuplicates();
+
+    QString parent;
+    for (auto module: modules) {
+        if (parent.size() && module.startsWith(parent)) {
+            continue;
+        }
+
+        parent = module;
+        module.chop(1);
+
+        const auto relative = qmlRoot.relativeFilePath(module);
+
+        if (relative.startsWith("..") || !QFileInfo(module).isDir()) {
+            QuasarAppUtils::Params::verboseLog("qml module " + module + " not found",
+                                               QuasarAppUtils::Warning);
+            continue;
+        }
+
+        if (!_fileManager->copyFolder(module, target + "/" + relative, filter, copiedItems)) {
+            return false;
+        }
     }
 
     return true;
@@ -376,6 +478,10 @@ bool Extracter::extractQmlFromSource() {
 
     auto cnf = DeployCore::_config;
 
+    if (QFileInfo::exists(cnf->qtDir.getQmls())) {
+        prepareQmlIndex();
+    }
+
     for (auto i = cnf->packages().cbegin(); i != cnf->packages().cend(); ++i) {
         auto targetPath = cnf->getTargetDir() + "/" + i.key();
         auto distro = cnf->getDistroFromPackage(i.key());
@@ -399,7 +505,7 @@ bool Extracter::extractQmlFromSource() {
                 continue;
             }
 
-            QML ownQmlScaner(cnf->qtDir.getQmls());
+            QML ownQmlScaner(cnf->qtDir.getQmls(), &_qmlIndex);
 
             if (!ownQmlScaner.scan(plugins, info.absoluteFilePath())) {
                 QuasarAppUtils::Params::verboseLog("qml scaner run failed!",
@@ -408,15 +514,12 @@ bool Extracter::extractQmlFromSource() {
             }
         }
 
-        if (!_fileManager->copyFolder(cnf->qtDir.getQmls(),
-                                     targetPath + distro.getQmlOutDir(),
-                        filter , &listItems, &plugins)) {
+        if (!copyQmlModules(plugins, targetPath + distro.getQmlOutDir(), filter, &listItems)) {
             return false;
         }
 
-        for (const auto &item : listItems) {
-            extractPluginLib(item, i.key());
-        }
+        _fileManager->waitForCopies(&listItems);
+        extractPluginLibs(listItems, i.key());
 
     }
 
@@ -435,25 +538,32 @@ bool Extracter::extractQml() {
     return false;
 }
 
-void Extracter::extract(const QString &file,
+void Extracter::extract(const QStringList &files,
                         DependencyMap *depMap,
                         const QString &mask) {
 
     assert(depMap);
 
-    QFileInfo info(file);
+    QStringList libs;
 
-    auto sufix = info.completeSuffix();
+    for (const auto &file: files) {
+        QFileInfo info(file);
 
-    if (sufix.compare("dll", Qt::CaseSensitive) == 0 ||
-            sufix.compare("exe", Qt::CaseSensitive) == 0 ||
-            sufix.isEmpty() || sufix.contains("so", Qt::CaseSensitive)) {
+        auto sufix = info.completeSuffix();
 
-        extractLib(file, depMap, mask);
-    } else {
-        QuasarAppUtils::Params::verboseLog("file with sufix " + sufix + " not supported!");
+        if (sufix.compare("dll", Qt::CaseSensitive) == 0 ||
+                sufix.compare("exe", Qt::CaseSensitive) == 0 ||
+                sufix.isEmpty() || sufix.contains("so", Qt::CaseSensitive)) {
+
+            libs.push_back(file);
+        } else {
+            QuasarAppUtils::Params::verboseLog("file with sufix " + sufix + " not supported!");
+        }
     }
 
+    if (libs.size()) {
+        extractLibs(libs, depMap, mask);
+    }
 }
 
 Extracter::Extracter(FileManager *fileManager, ConfigParser *cqt,
@@ -29,7 +29,12 @@ class DEPLOYSHARED_EXPORT Extracter {
     ConfigParser *_cqt;
     MetaFileManager *_metaFileManager;
 
-    void extract(const QString &file, DependencyMap* depMap, const QString& mask = "");
+    QmlModuleIndex _qmlIndex;
+
+    /**
+     * @brief extract - extract dependencies of all supported binaries of files.
+     */
+    void extract(const QStringList &files, DependencyMap* depMap, const QString& mask = "");
     bool copyTranslations(const QStringList &list, const QString &package);
 
     bool extractQml();
@@ -37,18 +42,35 @@ class DEPLOYSHARED_EXPORT Extracter {
     QFileInfoList findFilesInsideDir(const QString &name, const QString &dirpath);
     bool extractQmlAll();
     bool extractQmlFromSource();
+
     /**
-     * @brief extractLib
-     * @param file file of lib
+     * @brief prepareQmlIndex - load the cached index of the qml dir of Qt or build it.
+     */
+    void prepareQmlIndex();
+
+    /**
+     * @brief copyQmlModules - schedule copy of the dirs of qml modules, the other files of qml dir are not visited.
+     * @param modules - absolute paths of the modules dirs.
+     * @param copiedItems - list of files in target dir, available after the FileManager::waitForCopies.
+     */
+    bool copyQmlModules(QStringList modules, const QString& target,
+                        const QStringList& filter, QStringList *copiedItems);
+    /**
+     * @brief extractLibs
+     * @param files files of libs, all files are scanned in one pass.
      * @param mask  extraction mask. Used to filter extracts objects
      */
-    void extractLib(const QString & file, DependencyMap *depMap, const QString& mask = "");
+    void extractLibs(const QStringList & files, DependencyMap *depMap, const QString& mask = "");
 
     bool deployMSVC();
     bool extractWebEngine();
 
 
-    bool copyPlugin(const QString &plugin, const QString &package);
+    /**
+     * @brief copyPlugin - schedule copy of plugin dir.
+     * @param copiedItems - list of files in target dir, available after the FileManager::waitForCopies.
+     */
+    bool copyPlugin(const QString &plugin, const QString &package, QStringList *copiedItems);
     void copyPlugins(const QStringList &list, const QString &package);
 
     /**
@@ -59,11 +81,11 @@ class DEPLOYSHARED_EXPORT Extracter {
     void extractPlugins();
     void copyFiles();
     void copyTr();
-    void copyExtraPlugins(const QString &package);
+    void copyExtraPlugins(const QString &package, QStringList *copiedItems);
     void copyLibs(const QSet<QString> &files, const QString &package);
 
     bool isWebEngine(const QString& package) const;
-    void extractPluginLib(const QString &item, const QString &package);
+    void extractPluginLibs(const QStringList &items, const QString &package);
 
 public:
     explicit Extracter(FileManager *fileManager, ConfigParser * cqt, DependenciesScanner *_scaner);
@@ -0,0 +1,354 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "filecopier.h"
+#include "deploymanifest.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QtGlobal>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
+// the max size of one request of the kernel copy (the sendfile can not copy more then 2 GB).
+#define KERNEL_COPY_CHUNK  (1024 * 1024 * 1024)
+#define BUFFER_SIZE        (1024 * 1024)
+
+CopyMethod FileCopier::copy(const QString &from, const QString &to, bool allowHardlink,
+                            quint64 *hash) {
+#ifdef Q_OS_UNIX
+    auto source = QFile::encodeName(from);
+    auto target = QFile::encodeName(to);
+
+    if (allowHardlink && ::link(source.constData(), target.constData()) == 0) {
+        if (hash) {
+            *hash = DeployManifest::contentHash(from);
+        }
+
+        return CopyMethod::Hardlink;
+    }
+
+    int in = ::open(source.constData(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return CopyMethod::NotCopied;
+    }
+
+    struct stat info;
+    if (fstat(in, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(in);
+        return CopyMethod::NotCopied;
+    }
+
+    int out = ::open(target.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, info.st_mode & 0777);
+    if (out < 0) {
+        ::close(in);
+        return CopyMethod::NotCopied;
+    }
+
+    CopyMethod method = CopyMethod::NotCopied;
+    bool fallback = true;
+    QCryptographicHash sha1(QCryptographicHash::Sha1);
+
+    if (reflink(in, out)) {
+        method = CopyMethod::Reflink;
+    } else if (kernelCopy(in, out, info.st_size, fallback)) {
+        method = CopyMethod::KernelCopy;
+    } else if (fallback && bufferedCopy(in, out, info.st_size, (hash)? &sha1: nullptr)) {
+        method = CopyMethod::BufferedCopy;
+    }
+
+    // the data of the kernel copy is read from the page cache.
+    if (hash && method != CopyMethod::NotCopied) {
+        *hash = (method == CopyMethod::BufferedCopy || hashData(in, sha1))?
+                    DeployManifest::contentHash(sha1.result()): 0;
+    }
+
+    // the umask can change the permissions of the created file.
+    if (method != CopyMethod::NotCopied) {
+        fchmod(out, info.st_mode & 07777);
+    }
+
+    bool closed = ::close(out) == 0;
+    ::close(in);
+
+    if (method == CopyMethod::NotCopied || !closed) {
+        ::unlink(target.constData());
+        return CopyMethod::NotCopied;
+    }
+
+    return method;
+#else
+    Q_UNUSED(from)
+    Q_UNUSED(to)
+    Q_UNUSED(allowHardlink)
+    Q_UNUSED(hash)
+
+    return CopyMethod::NotCopied;
+#endif
+}
+
+int FileCopier::linksCount(const QString &file) {
+#ifdef Q_OS_UNIX
+    struct stat info;
+    if (::stat(QFile::encodeName(file).constData(), &info) != 0) {
+        return 0;
+    }
+
+    return static_cast<int>(info.st_nlink);
+#else
+    Q_UNUSED(file)
+    return 0;
+#endif
+}
+
+TargetState FileCopier::compare(const QString &source, const QString &target,
+                                const DeployManifestItem *deployed) {
+    QFileInfo targetInfo(target);
+
+    if (!targetInfo.exists()) {
+        return TargetState::NotExists;
+    }
+
+    QFileInfo sourceInfo(source);
+
+    if (sourceInfo.lastModified() == targetInfo.lastModified()) {
+
+        // the target is changed after deploy.
+        if (deployed && deployed->hasInfo &&
+                (deployed->size != targetInfo.size() ||
+                 deployed->mtime != targetInfo.lastModified().toMSecsSinceEpoch())) {
+
+            return (sourceInfo.size() != targetInfo.size())? TargetState::Changed: TargetState::SameSize;
+        }
+
+        // the size of stripped target is less then the source, so the source is compared with the record of copy.
+        if (deployed && deployed->hasSource) {
+            if (deployed->sourceSize == sourceInfo.size() &&
+                    deployed->sourceMtime == sourceInfo.lastModified().toMSecsSinceEpoch()) {
+                return TargetState::Same;
+            }
+        } else if (sourceInfo.size() == targetInfo.size()) {
+            return TargetState::Same;
+        }
+    }
+
+    if (sourceInfo.size() != targetInfo.size()) {
+        return TargetState::Changed;
+    }
+
+    return TargetState::SameSize;
+}
+
+bool FileCopier::sameContent(const QString &source, const QString &target, quint64 *hash) {
+    QFile sourceFile(source);
+    QFile targetFile(target);
+
+    if (!sourceFile.open(QIODevice::ReadOnly) || !targetFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    if (sourceFile.size() != targetFile.size()) {
+        return false;
+    }
+
+    QCryptographicHash sha1(QCryptographicHash::Sha1);
+
+    while (!sourceFile.atEnd()) {
+        auto sourceData = sourceFile.read(BUFFER_SIZE);
+
+        if (sourceData.isEmpty() || sourceData != targetFile.read(sourceData.size())) {
+            return false;
+        }
+
+        if (hash) {
+            sha1.addData(sourceData);
+        }
+    }
+
+    if (hash) {
+        *hash = DeployManifest::contentHash(sha1.result());
+    }
+
+    return true;
+}
+
+bool FileCopier::copyModificationTime(const QString &source, const QString &target) {
+    QFile targetFile(target);
+
+    if (!targetFile.open(QIODevice::Append)) {
+        return false;
+    }
+
+    return targetFile.setFileTime(QFileInfo(source).lastModified(), QFileDevice::FileModificationTime);
+}
+
+bool FileCopier::reflink(int source, int target) {
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+    return ioctl(target, FICLONE, source) == 0;
+#else
+    Q_UNUSED(source)
+    Q_UNUSED(target)
+    return false;
+#endif
+}
+
+bool FileCopier::kernelCopy(int source, int target, qint64 size, bool &fallback) {
+    fallback = true;
+
+#ifdef Q_OS_LINUX
+
+#ifdef SYS_copy_file_range
+    bool copyRange = true;
+#else
+    bool copyRange = false;
+#endif
+
+    qint64 copied = 0;
+
+    while (copied < size) {
+        auto chunk = static_cast<size_t>(qMin<qint64>(size - copied, KERNEL_COPY_CHUNK));
+        ssize_t result = 0;
+
+#ifdef SYS_copy_file_range
+        if (copyRange) {
+            result = syscall(SYS_copy_file_range, source, nullptr, target, nullptr, chunk, 0);
+        } else
+#endif
+        {
+            result = sendfile(target, source, nullptr, chunk);
+        }
+
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+
+        // the copy_file_range is not supported by kernel or file systems, try the sendfile.
+        if (result < 0 && copyRange && !copied) {
+            copyRange = false;
+            continue;
+        }
+
+        if (result <= 0) {
+            // the offsets of files are changed, so the copy can not be continued by other method.
+            fallback = !copied;
+            return false;
+        }
+
+        copied += result;
+    }
+
+    return true;
+#else
+    Q_UNUSED(source)
+    Q_UNUSED(target)
+    Q_UNUSED(size)
+    return false;
+#endif
+}
+
+bool FileCopier::bufferedCopy(int source, int target, qint64 size, QCryptographicHash *hash) {
+#ifdef Q_OS_UNIX
+
+#ifdef Q_OS_LINUX
+    // the preallocation decreases the fragmentation of target file, errors are not critical.
+    if (size > 0) {
+        fallocate(target, FALLOC_FL_KEEP_SIZE, 0, size);
+    }
+#else
+    Q_UNUSED(size)
+#endif
+
+    std::vector<char> buffer(BUFFER_SIZE);
+
+    while (true) {
+        ssize_t readed = ::read(source, buffer.data(), buffer.size());
+
+        if (readed < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (readed < 0) {
+            return false;
+        }
+
+        if (readed == 0) {
+            return true;
+        }
+
+        if (hash) {
+            hash->addData(buffer.data(), static_cast<int>(readed));
+        }
+
+        ssize_t written = 0;
+        while (written < readed) {
+            ssize_t result = ::write(target, buffer.data() + written,
+                                     static_cast<size_t>(readed - written));
+
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (result <= 0) {
+                return false;
+            }
+
+            written += result;
+        }
+    }
+#else
+    Q_UNUSED(source)
+    Q_UNUSED(target)
+    Q_UNUSED(size)
+    Q_UNUSED(hash)
+    return false;
+#endif
+}
+
+bool FileCopier::hashData(int file, QCryptographicHash &hash) {
+#ifdef Q_OS_UNIX
+    std::vector<char> buffer(BUFFER_SIZE);
+    off_t offset = 0;
+
+    while (true) {
+        ssize_t readed = ::pread(file, buffer.data(), buffer.size(), offset);
+
+        if (readed < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (readed < 0) {
+            return false;
+        }
+
+        if (readed == 0) {
+            return true;
+        }
+
+        hash.addData(buffer.data(), static_cast<int>(readed));
+        offset += readed;
+    }
+#else
+    Q_UNUSED(file)
+    Q_UNUSED(hash)
+    return false;
+#endif
+}
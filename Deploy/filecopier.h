@@ -0,0 +1,107 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef FILECOPIER_H
+#define FILECOPIER_H
+
+#include <QString>
+#include "deploy_global.h"
+
+class QCryptographicHash;
+struct DeployManifestItem;
+
+/**
+ * @brief The CopyMethod enum - the way that was used to create the copy of file.
+ */
+enum class CopyMethod: quint8 {
+    /// file is not copied.
+    NotCopied,
+    /// target is a hard link to the source file.
+    Hardlink,
+    /// target shares the data blocks with the source file (FICLONE).
+    Reflink,
+    /// data is copied inside the kernel (copy_file_range or sendfile).
+    KernelCopy,
+    /// data is copied by the read/write loop into preallocated file.
+    BufferedCopy
+};
+
+/**
+ * @brief The TargetState enum - state of the existing target file in compare with the source file.
+ */
+enum class TargetState: quint8 {
+    /// target file not exists.
+    NotExists,
+    /// files have same modification time and the source is not changed since the copy.
+    Same,
+    /// files have same size but different modification time, the content should be compared.
+    SameSize,
+    /// files have different size.
+    Changed
+};
+
+/**
+ * @brief The FileCopier class - copy of files with the cheapest way supported by the file system.
+ * The methods are tried in order: hard link (only if allowed), reflink, kernel copy, buffered copy.
+ * Target file should not exist.
+ */
+class DEPLOYSHARED_EXPORT FileCopier
+{
+public:
+    /**
+     * @brief copy
+     * @param from - source file
+     * @param to - target file
+     * @param allowHardlink - create hard link if the source and the target are on the same file system.
+     * @param hash - the content hash of copied data (see DeployManifest::contentHash).
+     *  The buffered copy hashes the data while copying, the other methods read the source after the copy.
+     * @return used method or CopyMethod::NotCopied if file can not be copied by this class.
+     */
+    static CopyMethod copy(const QString& from, const QString& to, bool allowHardlink = false,
+                           quint64* hash = nullptr);
+
+    /**
+     * @brief linksCount
+     * @return count of hard links of file or 0 if it is unknown.
+     */
+    static int linksCount(const QString& file);
+
+    /**
+     * @brief compare - compare the modification time and the size of files.
+     *  The copies of incremental deploy have the modification time of the source.
+     * @param deployed - the record of the previous copy of target. If the size and the time of source
+     *  are same as recorded the target is not changed even if it was stripped,
+     *  else the target should have the same size as the source.
+     *  The target that differs from the recorded size or time is changed after deploy.
+     */
+    static TargetState compare(const QString& source, const QString& target,
+                               const DeployManifestItem* deployed = nullptr);
+
+    /**
+     * @brief sameContent
+     * @param hash - the content hash of source, it is computed while comparing.
+     * @return true if files have same content.
+     */
+    static bool sameContent(const QString& source, const QString& target, quint64* hash = nullptr);
+
+    /**
+     * @brief copyModificationTime - set the modification time of source file to target file.
+     */
+    static bool copyModificationTime(const QString& source, const QString& target);
+
+private:
+    static bool reflink(int source, int target);
+    static bool kernelCopy(int source, int target, qint64 size, bool &fallback);
+    static bool bufferedCopy(int source, int target, qint64 size, QCryptographicHash* hash);
+
+    /**
+     * @brief hashData - hash the content of file from the begin, the offset of file is not changed.
+     */
+    static bool hashData(int file, QCryptographicHash& hash);
+};
+
+#endif // FILECOPIER_H
@@ -9,10 +9,18 @@
 
 #include "filemanager.h"
 #include <QDir>
+#include <QDirIterator>
 #include <quasarapp.h>
 #include "configparser.h"
 #include "deploycore.h"
+#include "elfstrip.h"
+#include "filecopier.h"
+#include <QCryptographicHash>
+#include <QElapsedTimer>
 #include <QProcess>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
 #include <fstream>
 #include "pathutils.h"
 
@@ -20,11 +28,34 @@
 #include "windows.h"
 #endif
 
+#ifdef Q_OS_UNIX
+#include <climits>
+#include <unistd.h>
+#endif
+
+// the stat and unlink of files are fast, so only small pool is needed for them.
+#define META_THREADS 2
+#define QUEUE_SIZE_PER_THREAD 4
+#define CLEAR_BATCH_SIZE 64
+
 FileManager::FileManager() {
+    int threads = qMax(2, QThread::idealThreadCount());
+
+    _metaPool.setMaxThreadCount(META_THREADS);
+    _dataPool.setMaxThreadCount(threads);
+    _queueSlots.release(threads * QUEUE_SIZE_PER_THREAD);
+}
+
+FileManager::~FileManager() {
+    waitForCopies();
 }
 
 bool FileManager::initDir(const QString &path) {
 
+    if (_createdDirs.contains(path)) {
+        return true;
+    }
+
     if (!QFileInfo::exists(path)) {
         addToDeployed(path);
         if (!QDir().mkpath(path)) {
@@ -32,35 +63,68 @@ bool FileManager::initDir(const QString &path) {
         }
     }
 
+    _createdDirs.insert(path);
+
     return true;
 }
 
 
 QSet<QString> FileManager::getDeployedFiles() const {
+    QMutexLocker locker(&_deployedFilesLock);
     return _deployedFiles;
 }
 
 QStringList FileManager::getDeployedFilesStringList() const {
+    QMutexLocker locker(&_deployedFilesLock);
     return _deployedFiles.values();
 }
 
 void FileManager::loadDeployemendFiles(const QString &targetDir) {
-    auto settings = QuasarAppUtils::Settings::get();
-
     if (targetDir.isEmpty())
         return;
 
-    QStringList deployedFiles = settings->getValue(targetDir, "").toStringList();
+    _manifest.setManifestFile(DeployManifest::manifestFile(targetDir));
+
+    QStringList deployedFiles;
+
+    if (_manifest.load()) {
+        deployedFiles = _manifest.paths();
+    } else {
+        // the old versions save the list of deployed files in the settings.
+        auto settings = QuasarAppUtils::Settings::get();
+        deployedFiles = settings->getValue(targetDir, "").toStringList();
+
+        for (const auto &file: deployedFiles) {
+            _manifest.append(file);
+        }
+    }
 
 //    _deployedFiles.clear();
+    QMutexLocker locker(&_deployedFilesLock);
     _deployedFiles.unite(QSet<QString>(deployedFiles.begin(), deployedFiles.end()));
 }
 
 
-bool FileManager::addToDeployed(const QString& path) {
+bool FileManager::addToDeployed(const QString& path, const QString& source, quint64 hash) {
     auto info = QFileInfo(path);
     if (info.isFile() || !info.exists()) {
-        _deployedFiles += info.absoluteFilePath();
+        bool added = false;
+
+        {
+            QMutexLocker locker(&_deployedFilesLock);
+            added = !_deployedFiles.contains(info.absoluteFilePath());
+            _deployedFiles += info.absoluteFilePath();
+        }
+
+        // the record of the previous deploy is replaced, the file can be copied from other source.
+        if (added || info.isFile()) {
+            _manifest.append(info.absoluteFilePath(), source, hash);
+        }
+
+        // the hard link shares the permissions and attributes with the source installation.
+        if (info.isFile() && FileCopier::linksCount(info.absoluteFilePath()) > 1) {
+            return true;
+        }
 
         auto completeSufix = info.completeSuffix();
         if (info.isFile() && (completeSufix.isEmpty() || completeSufix.toLower() == "run"
@@ -88,11 +152,18 @@ bool FileManager::addToDeployed(const QString& path) {
 }
 
 void FileManager::saveDeploymendFiles(const QString& targetDir) {
-    auto settings = QuasarAppUtils::Settings::get();
-    settings->setValue(targetDir, getDeployedFilesStringList());
+    if (targetDir.isEmpty())
+        return;
+
+    auto manifestFile = DeployManifest::manifestFile(targetDir);
+    if (_manifest.getManifestFile() != manifestFile) {
+        _manifest.setManifestFile(manifestFile);
+    }
+
+    _manifest.save(getDeployedFilesStringList());
 }
 
-bool FileManager::strip(const QString &dir) const {
+bool FileManager::strip(const QString &dir) {
 
 #ifdef Q_OS_WIN
     Q_UNUSED(dir)
@@ -105,38 +176,142 @@ bool FileManager::strip(const QString &dir) const {
         return false;
     }
 
-    if (info.isDir()) {
-        QDir d(dir);
-        auto list = d.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    QStringList files;
+    QList<QFileInfo> stack = {info};
 
-        bool res = false;
-        for (const auto &i : list) {
-            res = strip(i.absoluteFilePath()) || res;
+    while (stack.size()) {
+        auto item = stack.takeLast();
+
+        if (item.isDir()) {
+            stack += QDir(item.absoluteFilePath()).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+        } else {
+            files.push_back(item.absoluteFilePath());
         }
+    }
 
-        return res;
-    } else {
+    return stripFiles(files);
+#endif
+}
 
-        auto sufix = info.completeSuffix();
-        if (!sufix.contains("so") && !sufix.contains("dll")) {
-            return true;
+bool FileManager::stripDeployed() {
+    QStringList files;
+
+    {
+        QMutexLocker locker(&_transferredFilesLock);
+        files.swap(_transferredFiles);
+    }
+
+    files.removeDuplicates();
+
+    return stripFiles(files);
+}
+
+bool FileManager::stripFiles(const QStringList &files) {
+#ifdef Q_OS_WIN
+    Q_UNUSED(files)
+    return true;
+#else
+    QElapsedTimer timer;
+    timer.start();
+
+    QAtomicInt failed;
+    QAtomicInt stripped;
+
+    std::function<void(const QString &)> strip = [this, &failed, &stripped](const QString &file) {
+        QElapsedTimer fileTimer;
+        fileTimer.start();
+
+        switch (stripFile(file)) {
+        case StripResult::Stripped:
+            stripped.ref();
+            QuasarAppUtils::Params::verboseLog(QString("strip %0 (%1 ms)").
+                                               arg(file).arg(fileTimer.elapsed()),
+                                               QuasarAppUtils::Info);
+            break;
+        case StripResult::Failed:
+            failed.ref();
+            QuasarAppUtils::Params::verboseLog("strip of " + file + " failed", QuasarAppUtils::Warning);
+            break;
+        default:
+            break;
+        }
+    };
+
+    // the global pool has one thread per core.
+    QStringList jobs = files;
+    QtConcurrent::blockingMap(jobs, strip);
+
+    if (stripped.load()) {
+        qInfo() << QString("Stripped %0 files in %1 ms").arg(stripped.load()).arg(timer.elapsed());
+    }
+
+    return !failed.load();
+#endif
+}
+
+static bool isStrippable(const QFileInfo &info) {
+    auto sufix = info.completeSuffix();
+    return sufix.contains("so") || sufix.contains("dll");
+}
+
+FileManager::StripResult FileManager::stripFile(const QString &file) {
+    QFileInfo info(file);
+
+    // the strip of the link replaces it by the stripped file.
+    if (!info.isFile() || info.isSymLink() || !isStrippable(info)) {
+        return StripResult::Skipped;
+    }
+
+    // the hard link shares data with the source file, so it must not be changed.
+    if (FileCopier::linksCount(info.absoluteFilePath()) > 1) {
+        QuasarAppUtils::Params::verboseLog("skip strip of hard link " + info.absoluteFilePath());
+        return StripResult::Skipped;
+    }
+
+    auto modified = info.lastModified();
+
+    auto debug = debugFile(info.absoluteFilePath());
+    quint64 hash = 0;
+
+    // the external strip is used only for files that are not supported by the built-in strip.
+    if (!ElfStrip::strip(info.absoluteFilePath(), debug, &hash)) {
+        if (debug.size()) {
+            QuasarAppUtils::Params::verboseLog("skip strip of " + info.absoluteFilePath() +
+                                               ", the debug info can not be saved",
+                                               QuasarAppUtils::Warning);
+            return StripResult::Skipped;
         }
 
+        // the content is changed by the external strip, the hash of the deployed file is unknown.
+        _manifest.updateHash(info.absoluteFilePath(), 0);
+
         QProcess P;
         P.setProgram("strip");
         P.setArguments(QStringList() << info.absoluteFilePath());
         P.start();
 
         if (!P.waitForStarted())
-            return false;
+            return StripResult::Failed;
         if (!P.waitForFinished())
-            return false;
+            return StripResult::Failed;
 
-        return P.exitCode() == 0;
+        if (P.exitCode() != 0) {
+            return StripResult::Failed;
+        }
+    } else {
+        _manifest.updateHash(info.absoluteFilePath(), hash);
+    }
+
+    // the incremental deploy compares the modification time of the target with the source.
+    if (QuasarAppUtils::Params::isEndable("incremental")) {
+        QFile stripped(info.absoluteFilePath());
+        if (stripped.open(QIODevice::Append)) {
+            stripped.setFileTime(modified, QFileDevice::FileModificationTime);
+        }
     }
-#endif
-}
 
+    return StripResult::Stripped;
+}
 
 bool FileManager::fileActionPrivate(const QString &file, const QString &target,
                                          QStringList *masks, bool isMove) {
@@ -158,36 +333,416 @@ bool FileManager::fileActionPrivate(const QString &file, const QString &target,
         return false;
     }
 
-    auto name = info.fileName();
-    info.setFile(target + QDir::separator() + name);
+    auto targetFile = target + QDir::separator() + info.fileName();
+    info.setFile(targetFile);
 
     if (!initDir(info.absolutePath())) {
         return false;
     }
 
-    if (QFileInfo(file).absoluteFilePath() ==
-            QFileInfo(target + QDir::separator() + name).absoluteFilePath()) {
+    if (QFileInfo(file).absoluteFilePath() == info.absoluteFilePath()) {
+        return true;
+    }
+
+    if (!isMove) {
+        if (!copySymLink(file, target, targetFile)) {
+            scheduleCopy(file, targetFile);
+        }
+
+        return true;
+    }
+
+    return prepareTarget(targetFile) && transferFile(file, targetFile, isMove);
+}
+
+bool FileManager::copySymLink(const QString &file, const QString &target, const QString &targetFile) {
+#ifdef Q_OS_UNIX
+    if (!QuasarAppUtils::Params::isEndable("keepSymlinks") || !QFileInfo(file).isSymLink()) {
+        return false;
+    }
+
+    char buffer[PATH_MAX];
+    auto size = ::readlink(QFile::encodeName(file).constData(), buffer, sizeof(buffer) - 1);
+
+    if (size <= 0) {
+        return false;
+    }
+
+    // only the links to files of the same dir (libA.so.5 -> libA.so.5.14.2) are recreated.
+    const QByteArray linkTarget(buffer, static_cast<int>(size));
+    if (linkTarget.contains('/')) {
+        return false;
+    }
+
+    QFileInfo linked(QFileInfo(file).absolutePath() + "/" + QFile::decodeName(linkTarget));
+    if (!linked.exists()) {
+        return false;
+    }
+
+    if (_scheduledFiles.contains(targetFile)) {
         return true;
     }
 
+    // the linked file (or the next link of chain) is deployed with the same name.
+    if (!fileActionPrivate(linked.absoluteFilePath(), target, nullptr, false)) {
+        return false;
+    }
+
+    _scheduledFiles.insert(targetFile);
+
+    auto targetName = QFile::encodeName(targetFile);
+    QFileInfo targetInfo(targetFile);
+
+    if (targetInfo.isSymLink() &&
+            (size = ::readlink(targetName.constData(), buffer, sizeof(buffer) - 1)) > 0 &&
+            QByteArray(buffer, static_cast<int>(size)) == linkTarget) {
+
+        addToDeployed(targetFile);
+        return true;
+    }
+
+    // the old target can not be removed, the copy reports the fail.
+    if ((targetInfo.exists() || targetInfo.isSymLink()) && !prepareTarget(targetFile)) {
+        _scheduledFiles.remove(targetFile);
+        return false;
+    }
+
+    if (::symlink(linkTarget.constData(), targetName.constData()) != 0) {
+        QuasarAppUtils::Params::verboseLog("Failed to create the symlink " + targetFile,
+                                           QuasarAppUtils::Warning);
+        _scheduledFiles.remove(targetFile);
+        return false;
+    }
+
+    qInfo() << "link :" << targetFile << "->" << QFile::decodeName(linkTarget);
+    addToDeployed(targetFile);
+
+    return true;
+#else
+    Q_UNUSED(file)
+    Q_UNUSED(target)
+    Q_UNUSED(targetFile)
+    return false;
+#endif
+}
+
+void FileManager::scheduleCopy(const QString &file, const QString &targetFile) {
+
+    // two tasks of the same target will remove and write one file at the same time.
+    if (_scheduledFiles.contains(targetFile)) {
+        return;
+    }
+
+    _scheduledFiles.insert(targetFile);
+    _queueSlots.acquire();
+
+    QtConcurrent::run(&_metaPool, [this, file, targetFile]() {
+        prepareCopy(file, targetFile);
+    });
+}
+
+void FileManager::prepareCopy(const QString &file, const QString &targetFile) {
+    auto state = TargetState::Changed;
+    DeployManifestItem deployed;
+
+    if (QuasarAppUtils::Params::isEndable("incremental")) {
+        bool hasRecord = _manifest.find(QFileInfo(targetFile).absoluteFilePath(), deployed);
+
+        state = FileCopier::compare(file, targetFile, (hasRecord)? &deployed: nullptr);
+    }
+
+    // the content of not changed target is same as at the previous deploy.
+    if (state == TargetState::Same) {
+        _unchangedFiles.ref();
+        addToDeployed(targetFile, file, deployed.hash);
+        finishCopy(targetFile, true);
+        return;
+    }
+
+    // the content of files with same size is compared in the data pool.
+    if (state != TargetState::SameSize && !prepareTarget(targetFile)) {
+        finishCopy(targetFile, false);
+        return;
+    }
+
+    QtConcurrent::run(&_dataPool, [this, file, targetFile, state]() {
+        copyData(file, targetFile, state);
+    });
+}
+
+void FileManager::copyData(const QString &file, const QString &targetFile, TargetState state) {
+    if (state == TargetState::SameSize) {
+        quint64 hash = 0;
+
+        if (FileCopier::sameContent(file, targetFile, &hash)) {
+            FileCopier::copyModificationTime(file, targetFile);
+
+            _updatedFiles.ref();
+            addToDeployed(targetFile, file, hash);
+            finishCopy(targetFile, true);
+            return;
+        }
+
+        if (!prepareTarget(targetFile)) {
+            finishCopy(targetFile, false);
+            return;
+        }
+    }
+
+    // the same content is already copied in this run, the target will be a link to it.
+    if (scheduleDuplicate(file, targetFile)) {
+        finishCopy(targetFile, true);
+        return;
+    }
+
+    if (!transferFile(file, targetFile, false)) {
+        finishCopy(targetFile, false);
+        return;
+    }
+
+    // the next incremental deploy compares the modification time of files.
+    if (QuasarAppUtils::Params::isEndable("incremental")) {
+        FileCopier::copyModificationTime(file, targetFile);
+    }
+
+    _copiedFiles.ref();
+    finishCopy(targetFile, true);
+}
+
+void FileManager::finishCopy(const QString &targetFile, bool result) {
+    if (!result) {
+        QMutexLocker locker(&_failedCopiesLock);
+        _failedCopies.push_back(targetFile);
+    }
+
+    _queueSlots.release();
+}
+
+void FileManager::printCopyStatistic() const {
+    qInfo() << QString("Copy statistic: %0 copied, %1 updated, %2 unchanged").
+               arg(_copiedFiles.load()).
+               arg(_updatedFiles.load()).
+               arg(_unchangedFiles.load());
+
+    if (_dedupFiles) {
+        qInfo() << QString("Deduplication: %0 files are linked, %1 MB saved").
+                   arg(_dedupFiles).
+                   arg(QString::number(static_cast<double>(_dedupBytes) / (1024 * 1024), 'f', 1));
+    }
+}
+
+quint64 FileManager::sourceHash(const QString &file) {
+    QByteArray key;
+
+    {
+        QMutexLocker locker(&_dedupLock);
+        key = _sourceKeys.value(file);
+    }
+
+    if (key.isEmpty()) {
+        return 0;
+    }
+
+    return DeployManifest::contentHash(QByteArray::fromHex(key.mid(key.indexOf(':') + 1)));
+}
+
+QByteArray FileManager::contentKey(const QString &file) {
+    QFile source(file);
+
+    if (!source.open(QIODevice::ReadOnly)) {
+        return "";
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    if (!hash.addData(&source)) {
+        return "";
+    }
+
+    return QByteArray::number(source.size()) + ":" + hash.result().toHex();
+}
+
+bool FileManager::scheduleDuplicate(const QString &file, const QString &targetFile) {
+    if (!QuasarAppUtils::Params::isEndable("dedup")) {
+        return false;
+    }
+
+    QByteArray key;
+
+    {
+        QMutexLocker locker(&_dedupLock);
+        key = _sourceKeys.value(file);
+    }
+
+    // each source file is hashed once, the hash is computed without lock.
+    if (key.isEmpty()) {
+        key = contentKey(file);
+
+        if (key.isEmpty()) {
+            return false;
+        }
+
+        QMutexLocker locker(&_dedupLock);
+        _sourceKeys.insert(file, key);
+    }
+
+    QMutexLocker locker(&_dedupLock);
+    auto it = _dedupTargets.constFind(key);
+
+    if (it == _dedupTargets.constEnd()) {
+        _dedupTargets.insert(key, targetFile);
+        return false;
+    }
+
+    if (it.value() == targetFile) {
+        return false;
+    }
+
+    _dedupLinks.push_back({file, it.value(), targetFile});
+    return true;
+}
+
+bool FileManager::createDuplicates() {
+    QList<DedupLink> links;
+
+    {
+        QMutexLocker locker(&_dedupLock);
+        links.swap(_dedupLinks);
+    }
+
+    bool symlink = QuasarAppUtils::Params::getStrArg("dedup") == "symlink";
+    bool result = true;
+
+    for (const auto &link: links) {
+        bool created = false;
+        bool shared = false;
+
+        if (QFileInfo::exists(link.original)) {
+#ifdef Q_OS_UNIX
+            if (symlink) {
+                auto relative = QDir(QFileInfo(link.target).absolutePath()).relativeFilePath(link.original);
+                created = shared = ::symlink(QFile::encodeName(relative).constData(),
+                                             QFile::encodeName(link.target).constData()) == 0;
+            }
+#endif
+            if (!created) {
+                auto method = FileCopier::copy(link.original, link.target, !symlink);
+                created = method != CopyMethod::NotCopied;
+                shared = method == CopyMethod::Hardlink || method == CopyMethod::Reflink;
+            }
+        }
+
+        if (created) {
+            qInfo() << "link :" << link.target << "->" << link.original;
+
+            if (shared) {
+                ++_dedupFiles;
+                _dedupBytes += QFileInfo(link.original).size();
+            } else {
+                _copiedFiles.ref();
+            }
+
+            // the link has the content of the original target.
+            DeployManifestItem original;
+            _manifest.find(QFileInfo(link.original).absoluteFilePath(), original);
+
+            addToDeployed(link.target, link.source, original.hash);
+            continue;
+        }
+
+        // the original is not copied, so the duplicate is copied from the source.
+        if (transferFile(link.source, link.target, false)) {
+            _copiedFiles.ref();
+        } else {
+            QMutexLocker locker(&_failedCopiesLock);
+            _failedCopies.push_back(link.target);
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+bool FileManager::waitForCopies(QStringList *copiedItems) {
+    // the metadata tasks schedule the data tasks, so they are waited first.
+    _metaPool.waitForDone();
+    _dataPool.waitForDone();
+    _scheduledFiles.clear();
+
+    // the duplicates are linked to the files that are copied now.
+    createDuplicates();
+
+    QMutexLocker locker(&_failedCopiesLock);
+
+    if (_failedCopies.isEmpty()) {
+        return true;
+    }
+
+    QuasarAppUtils::Params::verboseLog(QString("%0 files not copied: ").arg(_failedCopies.size()) +
+                                       _failedCopies.join(", "),
+                                       QuasarAppUtils::Warning);
+
+    if (copiedItems) {
+        QSet<QString> failed;
+        for (const auto &target: _failedCopies) {
+            failed.insert(QDir::cleanPath(target));
+        }
+
+        copiedItems->erase(std::remove_if(copiedItems->begin(), copiedItems->end(),
+                                          [&failed](const QString& item) {
+            return failed.contains(QDir::cleanPath(item));
+        }), copiedItems->end());
+    }
+
+    _failedCopies.clear();
+
+    return false;
+}
+
+bool FileManager::prepareTarget(const QString &targetFile) {
     if (!QuasarAppUtils::Params::isEndable("noOverwrite") &&
-            info.exists() && !removeFile( target + QDir::separator() + name)) {
+            QFileInfo::exists(targetFile) && !removeFile(targetFile)) {
         return false;
     }
 
+    return true;
+}
+
+bool FileManager::transferFile(const QString &file, const QString &targetFile, bool isMove) {
+
     qInfo() << ((isMove)? "move :": "copy :") << file;
 
+    // the hash of the deployed content is computed while copying.
+    quint64 hash = 0;
+
+    // the strip is done while copying, so the copied library is not stripped again.
+    if (!isMove && isStripOnCopy(file) &&
+            ElfStrip::copyStripped(file, targetFile, debugFile(targetFile), &hash)) {
+        addToDeployed(targetFile, file, hash);
+        return true;
+    }
+
+    // the source is already hashed by the dedup.
+    hash = sourceHash(file);
+
+    if (!isMove && FileCopier::copy(file, targetFile, QuasarAppUtils::Params::isEndable("hardlink"),
+                                    (hash)? nullptr: &hash) != CopyMethod::NotCopied) {
+        addToDeployed(targetFile, file, hash);
+        addToTransferred(targetFile);
+        return true;
+    }
+
     QFile sourceFile(file);
 
     if (!((isMove)?
-          sourceFile.rename(target + QDir::separator() + name):
-          sourceFile.copy(target + QDir::separator() + name))) {
+          sourceFile.rename(targetFile):
+          sourceFile.copy(targetFile))) {
 
-        QuasarAppUtils::Params::verboseLog("Qt Operation fail " + file + " >> " + target + QDir::separator() + name +
+        QuasarAppUtils::Params::verboseLog("Qt Operation fail " + file + " >> " + targetFile +
                                            " Qt error: " + sourceFile.errorString(),
                                            QuasarAppUtils::Warning);
 
-        bool tarExits = QFileInfo(target + QDir::separator() + name).exists();
+        bool tarExits = QFileInfo(targetFile).exists();
 
         if ((!tarExits) ||
             (tarExits && !QuasarAppUtils::Params::isEndable("noOverwrite"))) {
@@ -195,12 +750,12 @@ bool FileManager::fileActionPrivate(const QString &file, const QString &target,
             std::ifstream  src(file.toStdString(),
                                std::ios::binary);
 
-            std::ofstream  dst((target + QDir::separator() + name).toStdString(),
+            std::ofstream  dst(targetFile.toStdString(),
                                std::ios::binary);
 
             dst << src.rdbuf();
 
-            if (!QFileInfo::exists(target + QDir::separator() + name)) {
+            if (!QFileInfo::exists(targetFile)) {
                 QuasarAppUtils::Params::verboseLog("std Operation fail file not copied. "
                                                    "Сheck if you have access to the target dir",
                                                    QuasarAppUtils::Error);
@@ -214,8 +769,8 @@ bool FileManager::fileActionPrivate(const QString &file, const QString &target,
 
         } else {
 
-            if (QFileInfo(target + QDir::separator() + name).exists()) {
-                qInfo() << target + QDir::separator() + name << " already exists!";
+            if (QFileInfo(targetFile).exists()) {
+                qInfo() << targetFile << " already exists!";
                 return true;
             }
 
@@ -223,10 +778,54 @@ bool FileManager::fileActionPrivate(const QString &file, const QString &target,
         }
     }
 
-    addToDeployed(target + QDir::separator() + name);
+    addToDeployed(targetFile, (isMove)? QString(): file);
+    addToTransferred(targetFile);
     return true;
 }
 
+bool FileManager::isStripOnCopy(const QString &file) const {
+#ifdef Q_OS_WIN
+    Q_UNUSED(file)
+    return false;
+#else
+    if (QuasarAppUtils::Params::isEndable("noStrip") ||
+            QuasarAppUtils::Params::isEndable("hardlink")) {
+        return false;
+    }
+
+    return isStrippable(QFileInfo(file));
+#endif
+}
+
+QString FileManager::debugFile(const QString &targetFile) const {
+    auto symbolsDir = QuasarAppUtils::Params::getStrArg("debugSymbolsDir");
+
+    if (symbolsDir.isEmpty()) {
+        return "";
+    }
+
+    QFileInfo info(targetFile);
+    auto relative = info.fileName();
+
+    // the symbols dir repeats the structure of the target dir.
+    if (DeployCore::_config) {
+        auto path = QDir(DeployCore::_config->getTargetDir()).relativeFilePath(info.absoluteFilePath());
+        if (!path.startsWith("..")) {
+            relative = path;
+        }
+    }
+
+    QFileInfo debug(QDir(symbolsDir).absoluteFilePath(relative + ".debug"));
+    QDir().mkpath(debug.absolutePath());
+
+    return debug.absoluteFilePath();
+}
+
+void FileManager::addToTransferred(const QString &targetFile) {
+    QMutexLocker locker(&_transferredFilesLock);
+    _transferredFiles.push_back(targetFile);
+}
+
 bool FileManager::removeFile(const QString &file) {
     return removeFile(QFileInfo (file));
 }
@@ -258,7 +857,17 @@ bool FileManager::moveFile(const QString &file, const QString &target, QStringLi
 }
 
 bool FileManager::copyFolder(const QString &from, const QString &to, const QStringList &filter,
-                        QStringList *listOfCopiedItems, QStringList *mask) {
+                        QStringList *listOfCopiedItems, QStringList *mask, bool recursive) {
+
+    const PathMatcher filterMatcher(filter, ONLY_WIN_CASE_INSENSIATIVE);
+
+    return copyFolderPrivate(from, to, filter, filterMatcher, listOfCopiedItems, mask, recursive);
+}
+
+bool FileManager::copyFolderPrivate(const QString &from, const QString &to,
+                                    const QStringList &filter, const PathMatcher &filterMatcher,
+                                    QStringList *listOfCopiedItems, QStringList *mask,
+                                    bool recursive) {
 
     QDir fromDir(from);
 
@@ -267,20 +876,19 @@ bool FileManager::copyFolder(const QString &from, const QString &to, const QStri
     for (const auto &item : list) {
         if (QFileInfo(item).isDir()) {
 
-            copyFolder(item.absoluteFilePath(), to + "/" + item.fileName(), filter, listOfCopiedItems, mask);
+            if (!recursive) {
+                continue;
+            }
+
+            copyFolderPrivate(item.absoluteFilePath(), to + "/" + item.fileName(),
+                              filter, filterMatcher, listOfCopiedItems, mask, recursive);
         } else {
 
-            QString skipFilter = "";
-            for (const auto &i: filter) {
-                if (item.fileName().contains(i, ONLY_WIN_CASE_INSENSIATIVE)) {
-                    skipFilter = i;
-                    break;
-                }
-            }
+            int skipFilter = filterMatcher.find(item.fileName());
 
-            if (!skipFilter.isEmpty()) {
+            if (skipFilter >= 0) {
                 QuasarAppUtils::Params::verboseLog(
-                            item.absoluteFilePath() + " ignored by filter " + skipFilter,
+                            item.absoluteFilePath() + " ignored by filter " + filter.value(skipFilter),
                             QuasarAppUtils::VerboseLvl::Info);
                 continue;
             }
@@ -346,48 +954,147 @@ bool FileManager::moveFolder(const QString &from, const QString &to, const QStri
     return true;
 }
 
-void FileManager::clear(const QString& targetDir, bool force) {
-    qInfo() << "clear start!";
+ClearStatistic FileManager::removeItems(const QStringList &files, const QStringList &dirs) {
+    ClearStatistic result;
+    QMutex resultLock;
+    QStringList allDirs = dirs;
 
-    if (force) {
-        qInfo() << "clear force! " << targetDir;
+    for (int begin = 0; begin < files.size(); begin += CLEAR_BATCH_SIZE) {
+        int end = qMin(begin + CLEAR_BATCH_SIZE, files.size());
 
-        if (QDir(targetDir).removeRecursively()) {
-            return;
-        }
+        QtConcurrent::run(&_dataPool, [&files, begin, end, &result, &allDirs, &resultLock]() {
+            ClearStatistic batch;
+            QStringList batchDirs;
 
-        QuasarAppUtils::Params::verboseLog("Remove target Dir fail, try remove old deployemend files",
-                                           QuasarAppUtils::Warning);
-    }
+            for (int i = begin; i < end; ++i) {
+                const auto &path = files[i];
+
+                // the most of paths are files, so the type is checked only if the remove fails.
+                if (QFile::remove(path)) {
+                    ++batch.removedFiles;
+                    QuasarAppUtils::Params::verboseLog("Remove " + path + " because it is deployed file",
+                                                       QuasarAppUtils::Info);
+                    continue;
+                }
+
+                QFileInfo info(path);
+
+                if (info.isDir() && !info.isSymLink()) {
+                    batchDirs.push_back(path);
+                } else if (!info.exists() && !info.isSymLink()) {
+                    ++batch.skipped;
+                } else {
+                    ++batch.failed;
+                    QuasarAppUtils::Params::verboseLog("Failed to remove " + path, QuasarAppUtils::Warning);
+                }
+            }
 
-    QMap<int, QFileInfo> sortedOldData;
-    for (auto& i : _deployedFiles) {
-        sortedOldData.insertMulti(i.size(), QFileInfo(i));
+            QMutexLocker locker(&resultLock);
+            result.removedFiles += batch.removedFiles;
+            result.skipped += batch.skipped;
+            result.failed += batch.failed;
+            allDirs += batchDirs;
+        });
     }
 
-    for (auto it = sortedOldData.end(); it != sortedOldData.begin(); --it) {
+    _dataPool.waitForDone();
 
-        auto index = it - 1;
+    // the children are removed before the parents, so one pass is enough.
+    // the rmdir fails for the not empty dirs (they contain not deployed files).
+    allDirs.removeDuplicates();
 
-        if (!index.value().exists()) {
-            continue;
+    QVector<QPair<int, QString>> sortedDirs;
+    sortedDirs.reserve(allDirs.size());
+
+    for (const auto &dir: allDirs) {
+        sortedDirs.push_back({dir.count('/'), dir});
+    }
+
+    std::stable_sort(sortedDirs.begin(), sortedDirs.end(),
+                     [](const QPair<int, QString> &left, const QPair<int, QString> &right) {
+        return left.first > right.first;
+    });
+
+    QDir root;
+    for (const auto &dir: sortedDirs) {
+        if (root.rmdir(dir.second)) {
+            ++result.removedDirs;
+            QuasarAppUtils::Params::verboseLog("Remove " + dir.second + " because it is empty",
+                                               QuasarAppUtils::Info);
+        } else {
+            ++result.skipped;
         }
+    }
+
+    return result;
+}
+
+ClearStatistic FileManager::clear(const QString& targetDir, bool force) {
+    qInfo() << "clear start!";
 
-        if (index.value().isFile()) {
-            if (removeFile(index.value())) {
-                qInfo() << "Remove " << index.value().absoluteFilePath() << " because it is deployed file";
+    waitForCopies();
+    _createdDirs.clear();
+
+    {
+        QMutexLocker locker(&_dedupLock);
+        _dedupTargets.clear();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    ClearStatistic result;
+    QStringList deployed = getDeployedFilesStringList();
+
+    if (force) {
+        qInfo() << "clear force! " << targetDir;
+
+        QStringList files;
+        QStringList dirs = {QFileInfo(targetDir).absoluteFilePath()};
+
+        QDirIterator it(targetDir, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+                        QDirIterator::Subdirectories);
+
+        while (it.hasNext()) {
+            it.next();
+            auto info = it.fileInfo();
+
+            if (info.isDir() && !info.isSymLink()) {
+                dirs.push_back(info.absoluteFilePath());
+            } else {
+                files.push_back(info.absoluteFilePath());
             }
+        }
+
+        result = removeItems(files, dirs);
 
+        if (QFileInfo::exists(targetDir)) {
+            QuasarAppUtils::Params::verboseLog("Remove target Dir fail, try remove old deployemend files",
+                                               QuasarAppUtils::Warning);
         } else {
-            QDir qdir(index.value().absoluteFilePath());
-            if (!qdir.entryList(QDir::NoDotAndDotDot | QDir::AllEntries).count()) {
-                qdir.removeRecursively();
-                qInfo() << "Remove " << index.value().absoluteFilePath() << " because it is empty";
-            }
+            deployed.clear();
         }
     }
 
-    _deployedFiles.clear();
+    if (deployed.size()) {
+        auto deployedResult = removeItems(deployed, {});
+
+        result.removedFiles += deployedResult.removedFiles;
+        result.removedDirs += deployedResult.removedDirs;
+        result.skipped += deployedResult.skipped;
+        result.failed += deployedResult.failed;
+    }
+
+    {
+        QMutexLocker locker(&_deployedFilesLock);
+        _deployedFiles.clear();
+    }
+
+    qInfo() << QString("Removed %0 files and %1 dirs, skipped %2, failed %3 (%4 ms)").
+               arg(result.removedFiles).arg(result.removedDirs).
+               arg(result.skipped).arg(result.failed).arg(timer.elapsed());
+
+    return result;
 }
 
 bool FileManager::copyFile(const QString &file, const QString &target,
@@ -7,12 +7,30 @@
 
 #ifndef COPYPASTEMANAGER_H
 #define COPYPASTEMANAGER_H
+#include <QAtomicInt>
 #include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QSemaphore>
 #include <QSet>
 #include <QStringList>
+#include <QThreadPool>
 #include <deploy_global.h>
+#include "deploymanifest.h"
+#include "filecopier.h"
+#include "pathmatcher.h"
 
 
+/**
+ * @brief The ClearStatistic struct - counters of the removed items of FileManager::clear.
+ */
+struct DEPLOYSHARED_EXPORT ClearStatistic {
+    int removedFiles = 0;
+    int removedDirs = 0;
+    /// items that do not exist and dirs that contain not deployed files.
+    int skipped = 0;
+    int failed = 0;
+};
 
 class DEPLOYSHARED_EXPORT FileManager
 {
@@ -20,12 +38,189 @@ private:
     bool fileActionPrivate(const QString &file, const QString &target,
                            QStringList *mask, bool isMove);
 
+    /**
+     * @brief copyFolderPrivate - copy the dir tree, the filter is compiled once by the copyFolder.
+     */
+    bool copyFolderPrivate(const QString &from, const QString &to,
+                           const QStringList &filter, const PathMatcher &filterMatcher,
+                           QStringList *listOfCopiedItems, QStringList *mask,
+                           bool recursive);
+
+    /**
+     * @brief copySymLink - recreate the link of library (libA.so.5 -> libA.so.5.14.2) in the target dir
+     *  and copy the linked file, so the content of library is not duplicated.
+     *  Works only if the keepSymlinks option is enabled and the file links to a file of the same dir.
+     * @return false if the file should be copied as a regular file.
+     */
+    bool copySymLink(const QString &file, const QString &target, const QString &targetFile);
+
+    /**
+     * @brief prepareTarget - remove old target file if the overwrite is enabled.
+     */
+    bool prepareTarget(const QString &targetFile);
+
+    /**
+     * @brief transferFile - copy or move file into targetFile and add it to deployed files.
+     */
+    bool transferFile(const QString &file, const QString &targetFile, bool isMove);
+
+    /**
+     * @brief scheduleCopy - add copy of file into the queue of the copy pools.
+     *  The stat and unlink of old target are executed in the metadata pool,
+     *  the copy of data in the data pool. Blocks if the queue is full.
+     */
+    void scheduleCopy(const QString &file, const QString &targetFile);
+
+    /**
+     * @brief prepareCopy - the metadata part of copy. Compares the target with the source
+     *  if the incremental mode is enabled and removes old target.
+     */
+    void prepareCopy(const QString &file, const QString &targetFile);
+
+    /**
+     * @brief copyData - the data part of copy.
+     *  The targets with ambiguous state are compared by content and updated or replaced.
+     */
+    void copyData(const QString &file, const QString &targetFile, TargetState state);
+    void finishCopy(const QString &targetFile, bool result);
+
+    enum class StripResult: quint8 {
+        Skipped,
+        Stripped,
+        Failed
+    };
+
+    /**
+     * @brief stripFile - strip library in place and update its hash in the manifest.
+     */
+    StripResult stripFile(const QString &file);
+
+    /**
+     * @brief stripFiles - strip libraries of list in parallel.
+     * @return false if one of libraries is not stripped.
+     */
+    bool stripFiles(const QStringList &files);
+    void addToTransferred(const QString &targetFile);
+
+    /**
+     * @brief isStripOnCopy
+     * @return true if library should be stripped while copying.
+     */
+    bool isStripOnCopy(const QString &file) const;
+
+    /**
+     * @brief debugFile
+     * @return path of the file for the debug info of the target library
+     *  or empty string if the debug info is not saved (the debugSymbolsDir option is not used).
+     */
+    QString debugFile(const QString &targetFile) const;
+
     bool initDir(const QString &path);
+
+    /**
+     * @brief removeItems - remove files in parallel batches, then remove empty dirs bottom-up.
+     *  The paths that can not be removed as file are handled as dirs.
+     */
+    ClearStatistic removeItems(const QStringList& files, const QStringList& dirs);
     QSet<QString> _deployedFiles;
+    mutable QMutex _deployedFilesLock;
 
+    /**
+     * @brief _manifest - the deployed files of the target dir, new files are appended while deploying.
+     */
+    DeployManifest _manifest;
+
+    /**
+     * @brief _createdDirs - cache of dirs that already exist in the target dir.
+     */
+    QSet<QString> _createdDirs;
+
+    QThreadPool _metaPool;
+    QThreadPool _dataPool;
+
+    /**
+     * @brief _queueSlots - limit of not finished copies.
+     */
+    QSemaphore _queueSlots;
+
+    /**
+     * @brief _scheduledFiles - targets of copies that are not finished yet.
+     */
+    QSet<QString> _scheduledFiles;
+
+    QStringList _failedCopies;
+    QMutex _failedCopiesLock;
+
+    /**
+     * @brief _transferredFiles - files copied or moved after the last strip.
+     */
+    QStringList _transferredFiles;
+    QMutex _transferredFilesLock;
+
+    QAtomicInt _copiedFiles;
+    QAtomicInt _updatedFiles;
+    QAtomicInt _unchangedFiles;
+
+    /**
+     * @brief The DedupLink struct - the target that has same content as the original target.
+     */
+    struct DedupLink {
+        QString source;
+        QString original;
+        QString target;
+    };
+
+    /**
+     * @brief _dedupTargets - the first target of each content (key - size and sha1 of content).
+     */
+    QHash<QByteArray, QString> _dedupTargets;
+
+    /**
+     * @brief _sourceKeys - content keys of the source files.
+     */
+    QHash<QString, QByteArray> _sourceKeys;
+    QList<DedupLink> _dedupLinks;
+    QMutex _dedupLock;
+
+    int _dedupFiles = 0;
+    qint64 _dedupBytes = 0;
+
+    static QByteArray contentKey(const QString& file);
+
+    /**
+     * @brief sourceHash
+     * @return the content hash of source file from its dedup key or 0 if the source is not hashed by the dedup.
+     */
+    quint64 sourceHash(const QString& file);
+
+    /**
+     * @brief scheduleDuplicate - check if the content of file is already copied in this run.
+     * @return true if the target will be created as link to the copied file at the next barrier.
+     */
+    bool scheduleDuplicate(const QString& file, const QString& targetFile);
+
+    /**
+     * @brief createDuplicates - create the scheduled links (hardlinks or relative symlinks).
+     *  The duplicate is copied if the link can not be created.
+     */
+    bool createDuplicates();
 
 public:
     FileManager();
+    ~FileManager();
+
+    /**
+     * @brief waitForCopies - wait until all scheduled copies are finished.
+     *  Copied files can be used only after this barrier.
+     * @param copiedItems - list of scheduled target files, the targets of failed copies are removed from it.
+     * @return false if one of copies after last barrier failed.
+     */
+    bool waitForCopies(QStringList *copiedItems = nullptr);
+
+    /**
+     * @brief printCopyStatistic - print count of copied, updated (same content) and unchanged files.
+     */
+    void printCopyStatistic() const;
 
     bool copyFile(const QString &file, const QString &target,
                   QStringList *mask = nullptr);
@@ -46,21 +241,43 @@ public:
     bool moveFile(const QString &file, const QString &target,
                   QStringList *mask = nullptr);
 
+    /**
+     * @brief copyFolder - schedule copy of files of the dir.
+     * @param listOfCopiedItems - scheduled target files, pass it into the waitForCopies to remove the failed copies.
+     * @param recursive - if false the child dirs are not copied.
+     */
     bool copyFolder(const QString &from, const QString &to,
                     const QStringList &filter = QStringList(),
                     QStringList *listOfCopiedItems = nullptr,
-                    QStringList *mask = nullptr);
+                    QStringList *mask = nullptr,
+                    bool recursive = true);
 
     bool moveFolder(const QString &from, const QString &to, const QString &ignore);
 
-    void clear(const QString& targetDir, bool force);
+    /**
+     * @brief clear - remove the deployed files (or all files of target dir if force is true).
+     *  Files are removed in parallel batches, then the empty dirs are removed from the deepest.
+     */
+    ClearStatistic clear(const QString& targetDir, bool force);
 
 
     QStringList getDeployedFilesStringList() const;
     QSet<QString> getDeployedFiles() const;
 
-    bool strip(const QString &dir) const;
-    bool addToDeployed(const QString& path);
+    bool strip(const QString &dir);
+
+    /**
+     * @brief stripDeployed - strip libraries that were copied or moved in this run after the last call of this method.
+     *  Each library is stripped once, the libraries are stripped in parallel.
+     */
+    bool stripDeployed();
+
+    /**
+     * @brief addToDeployed - add path into the list and the manifest of deployed files.
+     * @param source - the copied file, its size and time are recorded for the next incremental deploy.
+     * @param hash - the content hash of path computed while copying, 0 if it is unknown.
+     */
+    bool addToDeployed(const QString& path, const QString& source = QString(), quint64 hash = 0);
 
     void saveDeploymendFiles(const QString &targetDir);
     void loadDeployemendFiles(const QString &targetDir);
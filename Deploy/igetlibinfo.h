@@ -16,6 +16,12 @@ class IGetLibInfo
 public:
     IGetLibInfo() = default;
     virtual bool getLibInfo(const QString& lib, LibInfo& info) const = 0;
+
+    /**
+     * @brief probePlatform - read only the header of file.
+     * @return platform of binary or UnknownPlatform if file is not a binary of this format.
+     */
+    virtual Platform probePlatform(const QString& lib) const = 0;
     virtual ~IGetLibInfo() = default;
 
 };
@@ -18,40 +18,64 @@ bool IgnoreRule::checkOnlytext(const QString &lib) {
     return false;
 }
 
-IgnoreRule::IgnoreRule() {
+IgnoreRule::IgnoreRule():
+    _labels(Qt::CaseInsensitive) {
 
 }
 
 void IgnoreRule::addRule(const IgnoreData &rule) {
     _data.push_back(rule);
+    _labels.addPattern(rule.label);
 }
 
-bool IgnoreRule::check(const LibInfo &info, const QString& ignoreLabel) const {
-    if (info.fullPath().contains(ignoreLabel, Qt::CaseInsensitive)) {
-        QuasarAppUtils::Params::verboseLog(info.fullPath() + " ignored by filter" + ignoreLabel);
-        return true;
-    }
+const IgnoreData* IgnoreRule::isIgnore(const LibInfo &info) const {
 
-    return false;
-}
+    const auto fullPath = info.fullPath();
+    QVector<int> matched;
 
-const IgnoreData* IgnoreRule::isIgnore(const LibInfo &info) const {
+    // only the rules with label in path are checked, the environment is checked last because it reads the file info.
+    if (!_labels.match(fullPath, &matched)) {
+        return nullptr;
+    }
 
-    for (const auto &ignore : _data) {
+    for (int id : matched) {
+        const auto &ignore = _data[id];
 
         bool checkPlatform = ((ignore.platform & info.getPlatform()) == info.getPlatform()) || ignore.platform == UnknownPlatform;
         bool checkPriority = (ignore.prority <= info.getPriority()) || ignore.prority == NotFile;
-        bool checkEnvirement = !ignore.enfirement.size() || ignore.enfirement.inThisEnvirement(info.fullPath());
 
-        if (checkPlatform && checkPriority && checkEnvirement && check(info, ignore.label)) {
-            return &ignore;
+        if (!checkPlatform || !checkPriority) {
+            continue;
+        }
+
+        if (ignore.enfirement.size() && !ignore.enfirement.inThisEnvirement(fullPath)) {
+            continue;
         }
 
+        QuasarAppUtils::Params::verboseLog(fullPath + " ignored by filter" + ignore.label);
+        return &ignore;
     }
 
     return nullptr;
 }
 
+QString IgnoreRule::fingerprint() const {
+    QString result;
+
+    for (const auto &ignore : _data) {
+        auto env = ignore.enfirement.environmentList();
+        env.sort();
+
+        result += QString("%0:%1:%2:%3;").
+                arg(ignore.label).
+                arg(ignore.platform).
+                arg(ignore.prority).
+                arg(env.join(DeployCore::getEnvSeparator()));
+    }
+
+    return result;
+}
+
 IgnoreData::IgnoreData(const QString &label) {
     this->label = label;
 }
@@ -10,6 +10,7 @@
 
 #include "envirement.h"
 #include "libinfo.h"
+#include "pathmatcher.h"
 
 #include <QString>
 #include <deploycore.h>
@@ -34,9 +35,13 @@ class IgnoreRule
 private:
     QList<IgnoreData> _data;
 
+    /**
+     * @brief _labels - labels of all rules, the id of label is the index of rule.
+     */
+    PathMatcher _labels;
+
     bool checkOnlytext(const QString& lib);
 
-    bool check(const LibInfo &info, const QString &ignoreLabel) const;
 public:
     IgnoreRule();
     void addRule(const IgnoreData& rule);
@@ -47,6 +52,12 @@ public:
      * @return const ptr to ignore data
      */
     const IgnoreData *isIgnore(const LibInfo& info) const;
+
+    /**
+     * @brief fingerprint
+     * @return string that identifies all rules of this object
+     */
+    QString fingerprint() const;
 };
 
 #endif // IGNORERULE_H
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "ldcache.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+#include <cstring>
+
+#define OLD_MAGIC        "ld.so-1.7.0"
+#define OLD_MAGIC_SIZE   11
+#define OLD_HEADER_SIZE  16
+#define OLD_ENTRY_SIZE   12
+
+#define NEW_MAGIC        "glibc-ld.so.cache1.1"
+#define NEW_MAGIC_SIZE   20
+#define NEW_HEADER_SIZE  48
+#define NEW_ENTRY_SIZE   24
+
+#define FLAG_TYPE_MASK     0x00ff
+#define FLAG_REQUIRED_MASK 0xff00
+
+// The cache is created by ldconfig of the host, so all values have the native byte order.
+template <class T>
+static T readValue(const uchar* data) {
+    return qFromUnaligned<T>(data);
+}
+
+static const char* readString(const uchar* data, quint64 size, quint64 offset) {
+    if (offset >= size) {
+        return nullptr;
+    }
+
+    auto str = reinterpret_cast<const char*>(data + offset);
+
+    if (!memchr(str, 0, static_cast<size_t>(size - offset))) {
+        return nullptr;
+    }
+
+    return str;
+}
+
+LdCache::LdCache() {
+
+}
+
+QString LdCache::defaultFile() {
+    return "/etc/ld.so.cache";
+}
+
+Platform LdCache::platformFromFlags(qint32 flags) {
+    switch (flags & FLAG_REQUIRED_MASK) {
+    case 0x0100: // sparc
+    case 0x0200: // ia64
+    case 0x0300: // x86_64
+    case 0x0400: // s390
+    case 0x0500: // powerpc
+    case 0x0700: // mips64 n64
+    case 0x0a00: // aarch64
+    case 0x0e00: // mips64 n64 nan2008
+    case 0x0f00: // riscv soft float
+    case 0x1000: // riscv double float
+    case 0x1100: // loongarch soft float
+    case 0x1200: // loongarch double float
+        return Unix64;
+    default:
+        return Unix32;
+    }
+}
+
+void LdCache::addEntry(const char *name, const char *path, qint32 flags) {
+    if (!(flags & FLAG_TYPE_MASK)) {
+        return;
+    }
+
+    QString fullPath = QString::fromUtf8(path);
+    int separator = fullPath.lastIndexOf('/');
+
+    if (separator < 0) {
+        return;
+    }
+
+    QString dir = fullPath.left(separator);
+    auto dirIt = _dirIndexes.constFind(dir);
+
+    if (dirIt == _dirIndexes.constEnd()) {
+        dirIt = _dirIndexes.insert(dir, _dirs.size());
+        _dirs.push_back(dir);
+    }
+
+    Entry entry;
+    entry.dir = *dirIt;
+    entry.fileName = fullPath.mid(separator + 1);
+    entry.platform = platformFromFlags(flags);
+
+    _names[QString::fromUtf8(name).toUpper()].push_back(_entries.size());
+    _entries.push_back(entry);
+}
+
+bool LdCache::readOld(const uchar *data, quint64 size, quint64 &end) {
+    if (size < OLD_HEADER_SIZE || memcmp(data, OLD_MAGIC, OLD_MAGIC_SIZE) != 0) {
+        return false;
+    }
+
+    quint64 count = readValue<quint32>(data + 12);
+    end = OLD_HEADER_SIZE + count * OLD_ENTRY_SIZE;
+
+    if (end > size) {
+        return false;
+    }
+
+    // the new format is appended to the old format, the dynamic linker uses the new one.
+    quint64 newBegin = (end + 7) & ~static_cast<quint64>(7);
+    if (newBegin + NEW_HEADER_SIZE <= size &&
+            memcmp(data + newBegin, NEW_MAGIC, NEW_MAGIC_SIZE) == 0) {
+        end = newBegin;
+        return true;
+    }
+
+    const uchar* strings = data + end;
+    const quint64 stringsSize = size - end;
+
+    for (quint64 i = 0; i < count; ++i) {
+        const uchar* entry = data + OLD_HEADER_SIZE + i * OLD_ENTRY_SIZE;
+
+        auto flags = readValue<qint32>(entry);
+        auto name = readString(strings, stringsSize, readValue<quint32>(entry + 4));
+        auto path = readString(strings, stringsSize, readValue<quint32>(entry + 8));
+
+        if (name && path) {
+            addEntry(name, path, flags);
+        }
+    }
+
+    end = 0;
+    return true;
+}
+
+bool LdCache::readNew(const uchar *data, quint64 size, quint64 begin) {
+    if (begin + NEW_HEADER_SIZE > size || memcmp(data + begin, NEW_MAGIC, NEW_MAGIC_SIZE) != 0) {
+        return false;
+    }
+
+    const uchar* header = data + begin;
+    const quint64 headerSize = size - begin;
+
+    quint64 count = readValue<quint32>(header + 20);
+
+    if (NEW_HEADER_SIZE + count * NEW_ENTRY_SIZE > headerSize) {
+        return false;
+    }
+
+    for (quint64 i = 0; i < count; ++i) {
+        const uchar* entry = header + NEW_HEADER_SIZE + i * NEW_ENTRY_SIZE;
+
+        auto flags = readValue<qint32>(entry);
+        auto name = readString(header, headerSize, readValue<quint32>(entry + 4));
+        auto path = readString(header, headerSize, readValue<quint32>(entry + 8));
+
+        if (name && path) {
+            addEntry(name, path, flags);
+        }
+    }
+
+    return true;
+}
+
+bool LdCache::load(const QString &file) {
+    _entries.clear();
+    _names.clear();
+    _dirs.clear();
+    _dirIndexes.clear();
+    _removedDirs.clear();
+    _fingerprint.clear();
+    _valid = false;
+
+    QFile cache(file);
+
+    if (!cache.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    auto size = static_cast<quint64>(cache.size());
+    const uchar* data = cache.map(0, cache.size());
+
+    if (!data) {
+        return false;
+    }
+
+    quint64 newBegin = 0;
+
+    if (size >= OLD_HEADER_SIZE && memcmp(data, OLD_MAGIC, OLD_MAGIC_SIZE) == 0) {
+        _valid = readOld(data, size, newBegin) && (!newBegin || readNew(data, size, newBegin));
+    } else {
+        _valid = readNew(data, size, 0);
+    }
+
+    cache.unmap(const_cast<uchar*>(data));
+
+    if (!_valid) {
+        _entries.clear();
+        _names.clear();
+        _dirs.clear();
+        _dirIndexes.clear();
+        return false;
+    }
+
+    QFileInfo info(file);
+    _fingerprint = QByteArray::number(info.size()) + ":" +
+            QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+
+    return true;
+}
+
+QStringList LdCache::find(const QString &upperName, Platform platform) const {
+    QStringList result;
+
+    auto it = _names.constFind(upperName);
+    if (it == _names.constEnd()) {
+        return result;
+    }
+
+    for (int index: *it) {
+        const auto &entry = _entries[index];
+
+        if (_removedDirs.contains(entry.dir)) {
+            continue;
+        }
+
+        if (platform != UnknownPlatform && !(entry.platform & platform)) {
+            continue;
+        }
+
+        result.push_back(_dirs[entry.dir] + "/" + entry.fileName);
+    }
+
+    return result;
+}
+
+QStringList LdCache::dirs() const {
+    QStringList result;
+
+    for (int i = 0; i < _dirs.size(); ++i) {
+        if (!_removedDirs.contains(i)) {
+            result.push_back(_dirs[i]);
+        }
+    }
+
+    return result;
+}
+
+void LdCache::removeDir(const QString &dir) {
+    auto it = _dirIndexes.constFind(dir);
+    if (it != _dirIndexes.constEnd()) {
+        _removedDirs.insert(*it);
+    }
+}
+
+bool LdCache::isValid() const {
+    return _valid;
+}
+
+int LdCache::size() const {
+    return _entries.size();
+}
+
+QByteArray LdCache::fingerprint() const {
+    return _fingerprint;
+}
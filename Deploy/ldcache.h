@@ -0,0 +1,89 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef LDCACHE_H
+#define LDCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include "deploy_global.h"
+#include "deploycore.h"
+
+/**
+ * @brief The LdCache class - reader of the /etc/ld.so.cache file.
+ * Supports the old format (ld.so-1.7.0), the new format (glibc-ld.so.cache1.1)
+ * and the old format with the new format appended to it.
+ * The order of libraries with the same name is the order of the cache file,
+ * which is the order of searching of the dynamic linker.
+ */
+class DEPLOYSHARED_EXPORT LdCache
+{
+public:
+    LdCache();
+
+    /**
+     * @brief load - read the cache file.
+     * @param file - path to the cache file
+     * @return true if file is valid ld.so.cache file.
+     */
+    bool load(const QString& file = defaultFile());
+
+    /**
+     * @brief find
+     * @param upperName - upper name of library
+     * @param platform - platform of library, UnknownPlatform for all platforms.
+     * @return full paths of libraries in order of the cache.
+     */
+    QStringList find(const QString& upperName, Platform platform = UnknownPlatform) const;
+
+    /**
+     * @brief dirs - all dirs of libraries of the cache.
+     */
+    QStringList dirs() const;
+
+    /**
+     * @brief removeDir - exclude all libraries of dir from results of the find method.
+     */
+    void removeDir(const QString& dir);
+
+    bool isValid() const;
+    int size() const;
+
+    /**
+     * @brief fingerprint - the size and the modification time of the loaded file.
+     */
+    QByteArray fingerprint() const;
+
+    static QString defaultFile();
+
+private:
+    struct Entry {
+        int dir = 0;
+        QString fileName;
+        Platform platform = UnknownPlatform;
+    };
+
+    bool readOld(const uchar* data, quint64 size, quint64 &end);
+    bool readNew(const uchar* data, quint64 size, quint64 begin);
+    void addEntry(const char *name, const char *path, qint32 flags);
+
+    static Platform platformFromFlags(qint32 flags);
+
+    QVector<Entry> _entries;
+    QHash<QString, QVector<int>> _names;
+    QStringList _dirs;
+    QHash<QString, int> _dirIndexes;
+    QSet<int> _removedDirs;
+
+    QByteArray _fingerprint;
+    bool _valid = false;
+};
+
+#endif // LDCACHE_H
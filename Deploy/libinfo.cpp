@@ -9,7 +9,7 @@
 #include "pathutils.h"
 
 bool operator ==(const LibInfo &left, const LibInfo &right) {
-    return left.fullPath() == right.fullPath();
+    return left.name == right.name && left.path == right.path;
 }
 
 bool operator <=(const LibInfo &left, const LibInfo &right){
@@ -28,10 +28,6 @@ bool operator >(const LibInfo &left, const LibInfo &right) {
     return left.priority > right.priority;
 }
 
-const QSet<LibInfo> &LibInfo::getAllDep() const {
-    return allDep;
-}
-
 Platform LibInfo::getPlatform() const {
     return platform;
 }
@@ -94,6 +90,14 @@ void LibInfo::setQtPath(const QString &value)
     qtPath = value;
 }
 
+QString LibInfo::getRpath() const {
+    return rpath;
+}
+
+void LibInfo::setRpath(const QString &value) {
+    rpath = value;
+}
+
 WinAPI LibInfo::getWinApi() const {
     return _winApi;
 }
@@ -120,9 +124,9 @@ void LibInfo::clear() {
     path = "";
     name = "";
     qtPath = "";
+    rpath = "";
     platform = Platform::UnknownPlatform;
     dependncies.clear();
-    allDep.clear();
 }
 
 bool LibInfo::isValid() const {
@@ -131,5 +135,5 @@ bool LibInfo::isValid() const {
 }
 
 uint qHash(const LibInfo &info) {
-    return qHash(info.fullPath());
+    return qHash(info.getName(), qHash(info.getPath()));
 }
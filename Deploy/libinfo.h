@@ -12,13 +12,12 @@
 
 class DEPLOYSHARED_EXPORT LibInfo {
 private:
-    QSet<LibInfo> allDep;
-
     Platform platform = Platform::UnknownPlatform;
     QString name;
     QString path;
     QSet<QString> dependncies;
     QString qtPath;
+    QString rpath;
     LibPriority priority = NotFile;
     WinAPI _winApi = WinAPI::NoWinAPI;
 
@@ -37,7 +36,6 @@ public:
     bool isValid() const;
 
     friend class DependenciesScanner;
-    const QSet<LibInfo>& getAllDep() const;
     Platform getPlatform() const;
     void setPlatform(const Platform &value);
     QString getName() const;
@@ -54,6 +52,12 @@ public:
     void setPriority(const LibPriority &value);
     QString getQtPath() const;
     void setQtPath(const QString &value);
+    /**
+     * @brief getRpath
+     * @return value of the DT_RUNPATH or DT_RPATH tag without expansion of the $ORIGIN, $LIB and $PLATFORM tokens.
+     */
+    QString getRpath() const;
+    void setRpath(const QString &value);
     WinAPI getWinApi() const;
     void setWinApi(WinAPI winApi);
     bool isDependetOfQt() const;
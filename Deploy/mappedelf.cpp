@@ -0,0 +1,427 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "mappedelf.h"
+
+#include <QtEndian>
+
+#define EI_NIDENT   16
+#define EI_CLASS    4
+#define EI_DATA     5
+#define ELFDATA2LSB 1
+#define ELFDATA2MSB 2
+
+#define SHN_XINDEX  0xffff
+
+#define PT_LOAD     1
+#define PT_DYNAMIC  2
+
+#define DT_NULL     0
+#define DT_NEEDED   1
+#define DT_STRTAB   5
+#define DT_STRSZ    10
+#define DT_SONAME   14
+#define DT_RPATH    15
+#define DT_RUNPATH  29
+
+MappedElf::MappedElf(const QString &file):
+    _file(file) {
+}
+
+MappedElf::~MappedElf() {
+    if (_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+    }
+
+    _file.close();
+}
+
+bool MappedElf::open() {
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    _size = static_cast<quint64>(_file.size());
+
+    if (_size < EI_NIDENT) {
+        return false;
+    }
+
+    _data = _file.map(0, _file.size());
+
+    if (!_data) {
+        return false;
+    }
+
+    return readHeader() && readProgramHeaders();
+}
+
+bool MappedElf::isValid() const {
+    return _data && _class != ElfClassNone;
+}
+
+MappedElf::ElfClass MappedElf::elfClass() const {
+    return _class;
+}
+
+bool MappedElf::isLittleEndian() const {
+    return _littleEndian;
+}
+
+const uchar *MappedElf::data() const {
+    return _data;
+}
+
+quint64 MappedElf::size() const {
+    return _size;
+}
+
+bool MappedElf::containsRange(quint64 offset, quint64 size) const {
+    return offset <= _size && size <= _size - offset;
+}
+
+const QVector<MappedElf::ProgramHeader> &MappedElf::programHeaders() const {
+    return _programHeaders;
+}
+
+quint16 MappedElf::readU16(quint64 offset) const {
+    if (!containsRange(offset, 2)) {
+        return 0;
+    }
+
+    return (_littleEndian)? qFromLittleEndian<quint16>(_data + offset):
+                            qFromBigEndian<quint16>(_data + offset);
+}
+
+quint32 MappedElf::readU32(quint64 offset) const {
+    if (!containsRange(offset, 4)) {
+        return 0;
+    }
+
+    return (_littleEndian)? qFromLittleEndian<quint32>(_data + offset):
+                            qFromBigEndian<quint32>(_data + offset);
+}
+
+quint64 MappedElf::readU64(quint64 offset) const {
+    if (!containsRange(offset, 8)) {
+        return 0;
+    }
+
+    return (_littleEndian)? qFromLittleEndian<quint64>(_data + offset):
+                            qFromBigEndian<quint64>(_data + offset);
+}
+
+quint64 MappedElf::readWord(quint64 offset) const {
+    return (_class == ElfClass64)? readU64(offset): readU32(offset);
+}
+
+bool MappedElf::readHeader() {
+    if (_data[0] != 0x7f || _data[1] != 'E' || _data[2] != 'L' || _data[3] != 'F') {
+        return false;
+    }
+
+    auto elfClass = _data[EI_CLASS];
+    if (elfClass != ElfClass32 && elfClass != ElfClass64) {
+        return false;
+    }
+
+    auto elfData = _data[EI_DATA];
+    if (elfData != ELFDATA2LSB && elfData != ELFDATA2MSB) {
+        return false;
+    }
+
+    _class = static_cast<ElfClass>(elfClass);
+    _littleEndian = elfData == ELFDATA2LSB;
+
+    if (_class == ElfClass64) {
+        if (_size < 64) {
+            _class = ElfClassNone;
+            return false;
+        }
+
+        _phoff = readU64(32);
+        _shoff = readU64(40);
+        _ehsize = readU16(52);
+        _phentsize = readU16(54);
+        _phnum = readU16(56);
+        _shentsize = readU16(58);
+        _shnum = readU16(60);
+        _shstrndx = readU16(62);
+    } else {
+        if (_size < 52) {
+            _class = ElfClassNone;
+            return false;
+        }
+
+        _phoff = readU32(28);
+        _shoff = readU32(32);
+        _ehsize = readU16(40);
+        _phentsize = readU16(42);
+        _phnum = readU16(44);
+        _shentsize = readU16(46);
+        _shnum = readU16(48);
+        _shstrndx = readU16(50);
+    }
+
+    return true;
+}
+
+bool MappedElf::readProgramHeaders() {
+    _programHeaders.clear();
+
+    if (!_phnum) {
+        return true;
+    }
+
+    if (!containsRange(_phoff, static_cast<quint64>(_phentsize) * _phnum)) {
+        return false;
+    }
+
+    _programHeaders.reserve(_phnum);
+
+    for (quint16 i = 0; i < _phnum; ++i) {
+        quint64 offset = _phoff + static_cast<quint64>(i) * _phentsize;
+        ProgramHeader header;
+
+        header.type = readU32(offset);
+
+        if (_class == ElfClass64) {
+            header.flags = readU32(offset + 4);
+            header.offset = readU64(offset + 8);
+            header.vaddr = readU64(offset + 16);
+            header.filesz = readU64(offset + 32);
+            header.memsz = readU64(offset + 40);
+            header.align = readU64(offset + 48);
+        } else {
+            header.offset = readU32(offset + 4);
+            header.vaddr = readU32(offset + 8);
+            header.filesz = readU32(offset + 16);
+            header.memsz = readU32(offset + 20);
+            header.flags = readU32(offset + 24);
+            header.align = readU32(offset + 28);
+        }
+
+        _programHeaders.push_back(header);
+    }
+
+    return true;
+}
+
+bool MappedElf::readSections() {
+    _sections.clear();
+
+    // the extended numbering stores count of sections in the first section header.
+    if (!_shoff || !_shnum || _shstrndx == SHN_XINDEX || _shstrndx >= _shnum) {
+        return false;
+    }
+
+    const quint16 entrySize = (_class == ElfClass64)? 64: 40;
+    if (_shentsize < entrySize || !containsRange(_shoff, static_cast<quint64>(_shentsize) * _shnum)) {
+        return false;
+    }
+
+    _sections.reserve(_shnum);
+
+    for (quint16 i = 0; i < _shnum; ++i) {
+        quint64 offset = _shoff + static_cast<quint64>(i) * _shentsize;
+        SectionHeader header;
+
+        header.name = readU32(offset);
+        header.type = readU32(offset + 4);
+
+        if (_class == ElfClass64) {
+            header.flags = readU64(offset + 8);
+            header.addr = readU64(offset + 16);
+            header.offset = readU64(offset + 24);
+            header.size = readU64(offset + 32);
+            header.link = readU32(offset + 40);
+            header.info = readU32(offset + 44);
+            header.addralign = readU64(offset + 48);
+            header.entsize = readU64(offset + 56);
+        } else {
+            header.flags = readU32(offset + 8);
+            header.addr = readU32(offset + 12);
+            header.offset = readU32(offset + 16);
+            header.size = readU32(offset + 20);
+            header.link = readU32(offset + 24);
+            header.info = readU32(offset + 28);
+            header.addralign = readU32(offset + 32);
+            header.entsize = readU32(offset + 36);
+        }
+
+        _sections.push_back(header);
+    }
+
+    const auto &names = _sections[_shstrndx];
+    return containsRange(names.offset, names.size);
+}
+
+const QVector<MappedElf::SectionHeader> &MappedElf::sections() const {
+    return _sections;
+}
+
+QByteArray MappedElf::sectionName(int index) const {
+    if (index < 0 || index >= _sections.size()) {
+        return {};
+    }
+
+    const auto &names = _sections[_shstrndx];
+    quint64 name = _sections[index].name;
+
+    if (name >= names.size) {
+        return {};
+    }
+
+    auto str = reinterpret_cast<const char*>(_data + names.offset + name);
+    return QByteArray(str, static_cast<int>(qstrnlen(str, static_cast<uint>(names.size - name))));
+}
+
+quint16 MappedElf::headerSize() const {
+    return _ehsize;
+}
+
+quint64 MappedElf::programHeadersOffset() const {
+    return _phoff;
+}
+
+quint64 MappedElf::programHeadersSize() const {
+    return static_cast<quint64>(_phentsize) * _phnum;
+}
+
+quint16 MappedElf::sectionNamesIndex() const {
+    return _shstrndx;
+}
+
+quint64 MappedElf::vaddrToOffset(quint64 vaddr) const {
+    for (const auto &header: _programHeaders) {
+        if (header.type == PT_LOAD &&
+                vaddr >= header.vaddr &&
+                vaddr - header.vaddr < header.filesz) {
+            return header.offset + (vaddr - header.vaddr);
+        }
+    }
+
+    return 0;
+}
+
+const char *MappedElf::stringAt(quint64 index) const {
+    if (!_strTab || index >= _strTabSize) {
+        return nullptr;
+    }
+
+    return _strTab + index;
+}
+
+bool MappedElf::readDynamic() {
+    _needed.clear();
+    _soname = nullptr;
+    _rpath = nullptr;
+    _runpath = nullptr;
+    _strTab = nullptr;
+    _strTabSize = 0;
+
+    const ProgramHeader *dynamic = nullptr;
+    for (const auto &header: _programHeaders) {
+        if (header.type == PT_DYNAMIC) {
+            dynamic = &header;
+            break;
+        }
+    }
+
+    if (!dynamic || !containsRange(dynamic->offset, dynamic->filesz)) {
+        return false;
+    }
+
+    const quint64 entrySize = (_class == ElfClass64)? 16: 8;
+    const quint64 wordSize = entrySize / 2;
+    const quint64 end = dynamic->offset + dynamic->filesz;
+
+    quint64 strTabAddr = 0;
+    QVector<quint64> needed;
+    quint64 soname = 0, rpath = 0, runpath = 0;
+    bool hasSoname = false, hasRpath = false, hasRunpath = false;
+
+    for (quint64 offset = dynamic->offset; offset + entrySize <= end; offset += entrySize) {
+        auto tag = readWord(offset);
+        auto value = readWord(offset + wordSize);
+
+        if (tag == DT_NULL) {
+            break;
+        }
+
+        switch (tag) {
+        case DT_NEEDED: needed.push_back(value); break;
+        case DT_STRTAB: strTabAddr = value; break;
+        case DT_STRSZ: _strTabSize = value; break;
+        case DT_SONAME: soname = value; hasSoname = true; break;
+        case DT_RPATH: rpath = value; hasRpath = true; break;
+        case DT_RUNPATH: runpath = value; hasRunpath = true; break;
+        default: break;
+        }
+    }
+
+    auto strTabOffset = vaddrToOffset(strTabAddr);
+    if (!strTabOffset || strTabOffset >= _size) {
+        _strTabSize = 0;
+        return false;
+    }
+
+    if (!_strTabSize || !containsRange(strTabOffset, _strTabSize)) {
+        _strTabSize = _size - strTabOffset;
+    }
+
+    _strTab = reinterpret_cast<const char*>(_data + strTabOffset);
+
+    // the string table must be terminated by zero, else strings can be read out of the map.
+    if (_strTab[_strTabSize - 1] != 0) {
+        _strTab = nullptr;
+        _strTabSize = 0;
+        return false;
+    }
+
+    _needed.reserve(needed.size());
+    for (auto index: needed) {
+        if (auto str = stringAt(index)) {
+            _needed.push_back(str);
+        }
+    }
+
+    if (hasSoname) {
+        _soname = stringAt(soname);
+    }
+
+    if (hasRpath) {
+        _rpath = stringAt(rpath);
+    }
+
+    if (hasRunpath) {
+        _runpath = stringAt(runpath);
+    }
+
+    return true;
+}
+
+const QVector<const char *> &MappedElf::needed() const {
+    return _needed;
+}
+
+const char *MappedElf::soname() const {
+    return _soname;
+}
+
+const char *MappedElf::rpath() const {
+    return _rpath;
+}
+
+const char *MappedElf::runpath() const {
+    return _runpath;
+}
+
+const char *MappedElf::stringTable(quint64 &size) const {
+    size = _strTabSize;
+    return _strTab;
+}
@@ -0,0 +1,168 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef MAPPEDELF_H
+#define MAPPEDELF_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QVector>
+#include "deploy_global.h"
+
+/**
+ * @brief The MappedElf class - zero-copy reader of ELF files.
+ * The file is mapped into memory and only the ELF header, the program headers
+ * and the PT_DYNAMIC segment are parsed. All returned strings point into the mapped file
+ * and are valid while this object is alive.
+ */
+class DEPLOYSHARED_EXPORT MappedElf
+{
+public:
+    enum ElfClass: quint8 {
+        ElfClassNone = 0,
+        ElfClass32 = 1,
+        ElfClass64 = 2
+    };
+
+    struct ProgramHeader {
+        quint32 type = 0;
+        quint32 flags = 0;
+        quint64 offset = 0;
+        quint64 vaddr = 0;
+        quint64 filesz = 0;
+        quint64 memsz = 0;
+        quint64 align = 0;
+    };
+
+    struct SectionHeader {
+        quint32 name = 0;
+        quint32 type = 0;
+        quint64 flags = 0;
+        quint64 addr = 0;
+        quint64 offset = 0;
+        quint64 size = 0;
+        quint32 link = 0;
+        quint32 info = 0;
+        quint64 addralign = 0;
+        quint64 entsize = 0;
+    };
+
+    explicit MappedElf(const QString& file);
+    ~MappedElf();
+
+    /**
+     * @brief open - map file and read ELF header.
+     * @return true if file is valid ELF file.
+     */
+    bool open();
+    bool isValid() const;
+
+    ElfClass elfClass() const;
+    bool isLittleEndian() const;
+
+    const uchar* data() const;
+    quint64 size() const;
+
+    /**
+     * @brief containsRange
+     * @return true if the range of size bytes from offset is inside the file.
+     *  The check does not overflow for any values read from the file.
+     */
+    bool containsRange(quint64 offset, quint64 size) const;
+
+    const QVector<ProgramHeader>& programHeaders() const;
+
+    /**
+     * @brief readSections - read the section header table and the section names.
+     * @return false if table is broken or uses the extended numbering.
+     */
+    bool readSections();
+    const QVector<SectionHeader>& sections() const;
+
+    /**
+     * @brief sectionName
+     * @return name of section or empty string.
+     */
+    QByteArray sectionName(int index) const;
+
+    /**
+     * @brief headerSize - the size of the ELF header (e_ehsize).
+     */
+    quint16 headerSize() const;
+    quint64 programHeadersOffset() const;
+    quint64 programHeadersSize() const;
+    quint16 sectionNamesIndex() const;
+
+    /**
+     * @brief readDynamic - read the PT_DYNAMIC segment.
+     * @return true if segment exists and is valid.
+     */
+    bool readDynamic();
+
+    const QVector<const char*>& needed() const;
+    const char* soname() const;
+    const char* rpath() const;
+    const char* runpath() const;
+
+    /**
+     * @brief stringTable - the DT_STRTAB of file (equals to the .dynstr section).
+     * @param size - size of string table
+     * @return pointer to begin of the string table or nullptr
+     */
+    const char* stringTable(quint64& size) const;
+
+    quint16 readU16(quint64 offset) const;
+    quint32 readU32(quint64 offset) const;
+    quint64 readU64(quint64 offset) const;
+
+    /**
+     * @brief readWord - read 4 byte value for 32bit and 8 byte value for 64bit files.
+     */
+    quint64 readWord(quint64 offset) const;
+
+    /**
+     * @brief vaddrToOffset
+     * @return offset in file of virtual address or 0 if address is not loaded from file.
+     */
+    quint64 vaddrToOffset(quint64 vaddr) const;
+
+private:
+    bool readHeader();
+    bool readProgramHeaders();
+    const char* stringAt(quint64 index) const;
+
+    QFile _file;
+    const uchar* _data = nullptr;
+    quint64 _size = 0;
+
+    ElfClass _class = ElfClassNone;
+    bool _littleEndian = true;
+
+    quint16 _ehsize = 0;
+
+    quint64 _phoff = 0;
+    quint16 _phentsize = 0;
+    quint16 _phnum = 0;
+
+    quint64 _shoff = 0;
+    quint16 _shentsize = 0;
+    quint16 _shnum = 0;
+    quint16 _shstrndx = 0;
+
+    QVector<ProgramHeader> _programHeaders;
+    QVector<SectionHeader> _sections;
+
+    const char* _strTab = nullptr;
+    quint64 _strTabSize = 0;
+
+    QVector<const char*> _needed;
+    const char* _soname = nullptr;
+    const char* _rpath = nullptr;
+    const char* _runpath = nullptr;
+};
+
+#endif // MAPPEDELF_H
@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "mappedpe.h"
+
+#include <QtEndian>
+#include <cstring>
+
+#define DOS_HEADER_SIZE     64
+#define DOS_LFANEW          0x3C
+#define COFF_HEADER_SIZE    20
+#define SECTION_HEADER_SIZE 40
+
+#define DIRECTORY_IMPORT       1
+#define DIRECTORY_DELAY_IMPORT 13
+
+#define IMPORT_DESCRIPTOR_SIZE       20
+#define DELAY_IMPORT_DESCRIPTOR_SIZE 32
+
+// the delay import descriptor uses RVAs if this attribute is set, else VAs (old linkers).
+#define DELAY_ATTRIBUTE_RVA 0x1
+
+MappedPe::MappedPe(const QString &file):
+    _file(file) {
+}
+
+MappedPe::~MappedPe() {
+    if (_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+    }
+
+    _file.close();
+}
+
+quint16 MappedPe::readU16(quint64 offset) const {
+    if (offset + 2 > _size) {
+        return 0;
+    }
+
+    return qFromLittleEndian<quint16>(_data + offset);
+}
+
+quint32 MappedPe::readU32(quint64 offset) const {
+    if (offset + 4 > _size) {
+        return 0;
+    }
+
+    return qFromLittleEndian<quint32>(_data + offset);
+}
+
+quint64 MappedPe::readU64(quint64 offset) const {
+    if (offset + 8 > _size) {
+        return 0;
+    }
+
+    return qFromLittleEndian<quint64>(_data + offset);
+}
+
+bool MappedPe::open() {
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    _size = static_cast<quint64>(_file.size());
+
+    if (_size < DOS_HEADER_SIZE) {
+        return false;
+    }
+
+    _data = _file.map(0, _file.size());
+
+    if (!_data) {
+        return false;
+    }
+
+    if (_data[0] != 'M' || _data[1] != 'Z') {
+        return false;
+    }
+
+    quint64 ntHeader = readU32(DOS_LFANEW);
+
+    if (ntHeader + 4 + COFF_HEADER_SIZE > _size ||
+            memcmp(_data + ntHeader, "PE\0\0", 4) != 0) {
+        return false;
+    }
+
+    quint64 coffHeader = ntHeader + 4;
+    quint16 sectionsCount = readU16(coffHeader + 2);
+    quint16 optionalHeaderSize = readU16(coffHeader + 16);
+
+    quint64 optionalHeader = coffHeader + COFF_HEADER_SIZE;
+
+    if (optionalHeader + optionalHeaderSize > _size) {
+        return false;
+    }
+
+    auto magic = readU16(optionalHeader);
+
+    if (magic == MagicPE32) {
+        _imageBase = readU32(optionalHeader + 28);
+        _sizeOfHeaders = readU32(optionalHeader + 60);
+        _directoriesCount = readU32(optionalHeader + 92);
+        _directoriesOffset = optionalHeader + 96;
+    } else if (magic == MagicPE32Plus) {
+        _imageBase = readU64(optionalHeader + 24);
+        _sizeOfHeaders = readU32(optionalHeader + 60);
+        _directoriesCount = readU32(optionalHeader + 108);
+        _directoriesOffset = optionalHeader + 112;
+    } else {
+        return false;
+    }
+
+    // the count of directories can not be more then the optional header contains.
+    quint64 directoriesEnd = optionalHeader + optionalHeaderSize;
+    if (_directoriesOffset > directoriesEnd) {
+        return false;
+    }
+
+    _directoriesCount = qMin<quint32>(_directoriesCount,
+                                      static_cast<quint32>((directoriesEnd - _directoriesOffset) / 8));
+
+    quint64 sectionTable = optionalHeader + optionalHeaderSize;
+
+    if (sectionTable + static_cast<quint64>(sectionsCount) * SECTION_HEADER_SIZE > _size) {
+        return false;
+    }
+
+    _sections.clear();
+    _sections.reserve(sectionsCount);
+
+    for (quint16 i = 0; i < sectionsCount; ++i) {
+        quint64 offset = sectionTable + static_cast<quint64>(i) * SECTION_HEADER_SIZE;
+
+        Section section;
+        section.virtualSize = readU32(offset + 8);
+        section.virtualAddress = readU32(offset + 12);
+        section.rawSize = readU32(offset + 16);
+        section.rawOffset = readU32(offset + 20);
+
+        _sections.push_back(section);
+    }
+
+    _magic = static_cast<OptionalMagic>(magic);
+
+    return true;
+}
+
+bool MappedPe::isValid() const {
+    return _data && _magic != MagicNone;
+}
+
+MappedPe::OptionalMagic MappedPe::magic() const {
+    return _magic;
+}
+
+quint64 MappedPe::rvaToOffset(quint64 rva) const {
+    for (const auto &section: _sections) {
+        quint64 size = qMax(section.virtualSize, section.rawSize);
+
+        if (rva >= section.virtualAddress && rva < section.virtualAddress + size) {
+            quint64 delta = rva - section.virtualAddress;
+
+            // this part of section is not stored in file.
+            if (delta >= section.rawSize) {
+                return 0;
+            }
+
+            return section.rawOffset + delta;
+        }
+    }
+
+    // the headers are mapped as is.
+    if (rva < _sizeOfHeaders && rva < _size) {
+        return rva;
+    }
+
+    return 0;
+}
+
+const char *MappedPe::stringAt(quint64 rva) const {
+    auto offset = rvaToOffset(rva);
+
+    if (!offset || offset >= _size) {
+        return nullptr;
+    }
+
+    auto str = reinterpret_cast<const char*>(_data + offset);
+
+    if (!memchr(str, 0, static_cast<size_t>(_size - offset))) {
+        return nullptr;
+    }
+
+    return str;
+}
+
+MappedPe::DataDirectory MappedPe::directory(int index) const {
+    DataDirectory result;
+
+    if (static_cast<quint32>(index) >= _directoriesCount) {
+        return result;
+    }
+
+    quint64 offset = _directoriesOffset + static_cast<quint64>(index) * 8;
+    result.rva = readU32(offset);
+    result.size = readU32(offset + 4);
+
+    return result;
+}
+
+bool MappedPe::readImportDirectory() {
+    auto dir = directory(DIRECTORY_IMPORT);
+
+    if (!dir.rva) {
+        return true;
+    }
+
+    quint64 offset = rvaToOffset(dir.rva);
+
+    if (!offset) {
+        return false;
+    }
+
+    for (; offset + IMPORT_DESCRIPTOR_SIZE <= _size; offset += IMPORT_DESCRIPTOR_SIZE) {
+        quint32 name = readU32(offset + 12);
+        quint32 firstThunk = readU32(offset + 16);
+
+        // the table is terminated by the empty descriptor.
+        if (!name && !firstThunk) {
+            return true;
+        }
+
+        auto str = stringAt(name);
+        if (!str) {
+            return false;
+        }
+
+        _imports.push_back(str);
+    }
+
+    return false;
+}
+
+bool MappedPe::readDelayImportDirectory() {
+    auto dir = directory(DIRECTORY_DELAY_IMPORT);
+
+    if (!dir.rva) {
+        return true;
+    }
+
+    quint64 offset = rvaToOffset(dir.rva);
+
+    if (!offset) {
+        return false;
+    }
+
+    for (; offset + DELAY_IMPORT_DESCRIPTOR_SIZE <= _size; offset += DELAY_IMPORT_DESCRIPTOR_SIZE) {
+        quint32 attributes = readU32(offset);
+        quint64 name = readU32(offset + 4);
+
+        if (!name) {
+            return true;
+        }
+
+        if (!(attributes & DELAY_ATTRIBUTE_RVA)) {
+            if (name < _imageBase) {
+                return false;
+            }
+
+            name -= _imageBase;
+        }
+
+        auto str = stringAt(name);
+        if (!str) {
+            return false;
+        }
+
+        _delayImports.push_back(str);
+    }
+
+    return false;
+}
+
+bool MappedPe::readImports() {
+    _imports.clear();
+    _delayImports.clear();
+
+    if (!isValid()) {
+        return false;
+    }
+
+    return readImportDirectory() && readDelayImportDirectory();
+}
+
+const QVector<const char *> &MappedPe::imports() const {
+    return _imports;
+}
+
+const QVector<const char *> &MappedPe::delayImports() const {
+    return _delayImports;
+}
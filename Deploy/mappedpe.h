@@ -0,0 +1,96 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef MAPPEDPE_H
+#define MAPPEDPE_H
+
+#include <QFile>
+#include <QVector>
+#include "deploy_global.h"
+
+/**
+ * @brief The MappedPe class - zero-copy reader of the import tables of PE files.
+ * The file is mapped into memory and only the DOS header, the NT headers, the section table,
+ * the import directory and the delay import directory are read.
+ * All returned strings point into the mapped file and are valid while this object is alive.
+ */
+class DEPLOYSHARED_EXPORT MappedPe
+{
+public:
+    enum OptionalMagic: quint16 {
+        MagicNone = 0x0,
+        MagicPE32 = 0x10B,
+        MagicPE32Plus = 0x20B
+    };
+
+    struct Section {
+        quint32 virtualAddress = 0;
+        quint32 virtualSize = 0;
+        quint32 rawOffset = 0;
+        quint32 rawSize = 0;
+    };
+
+    explicit MappedPe(const QString& file);
+    ~MappedPe();
+
+    /**
+     * @brief open - map file and read headers and section table.
+     * @return true if file is valid PE file.
+     */
+    bool open();
+    bool isValid() const;
+
+    OptionalMagic magic() const;
+
+    /**
+     * @brief readImports - read names of modules of the import and the delay import directories.
+     * @return false if one of directories is broken.
+     */
+    bool readImports();
+
+    const QVector<const char*>& imports() const;
+    const QVector<const char*>& delayImports() const;
+
+    /**
+     * @brief rvaToOffset
+     * @return offset in file of the relative virtual address or 0 if address is not in file.
+     */
+    quint64 rvaToOffset(quint64 rva) const;
+
+private:
+    struct DataDirectory {
+        quint32 rva = 0;
+        quint32 size = 0;
+    };
+
+    quint16 readU16(quint64 offset) const;
+    quint32 readU32(quint64 offset) const;
+    quint64 readU64(quint64 offset) const;
+    const char* stringAt(quint64 rva) const;
+    DataDirectory directory(int index) const;
+
+    bool readImportDirectory();
+    bool readDelayImportDirectory();
+
+    QFile _file;
+    const uchar* _data = nullptr;
+    quint64 _size = 0;
+
+    OptionalMagic _magic = MagicNone;
+    quint64 _imageBase = 0;
+    quint32 _sizeOfHeaders = 0;
+
+    quint64 _directoriesOffset = 0;
+    quint32 _directoriesCount = 0;
+
+    QVector<Section> _sections;
+
+    QVector<const char*> _imports;
+    QVector<const char*> _delayImports;
+};
+
+#endif // MAPPEDPE_H
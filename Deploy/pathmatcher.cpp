@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "pathmatcher.h"
+
+#include <algorithm>
+
+static quint64 edgeKey(int node, ushort c) {
+    return (static_cast<quint64>(node) << 16) | c;
+}
+
+PathMatcher::PathMatcher(Qt::CaseSensitivity cs):
+    _cs(cs) {
+    clear();
+}
+
+PathMatcher::PathMatcher(const QStringList &patterns, Qt::CaseSensitivity cs):
+    PathMatcher(cs) {
+    addPatterns(patterns);
+}
+
+ushort PathMatcher::fold(QChar c) const {
+    return (_cs == Qt::CaseInsensitive)? c.toCaseFolded().unicode(): c.unicode();
+}
+
+int PathMatcher::next(int node, ushort c) const {
+    return _edges.value(edgeKey(node, c), -1);
+}
+
+int PathMatcher::insert(const QString &pattern, bool prefix) {
+    Pattern item;
+    item.size = pattern.size();
+    item.prefix = prefix;
+
+    const int id = _patterns.size();
+    _patterns.push_back(item);
+
+    if (pattern.isEmpty()) {
+        _empty.push_back(id);
+        _compiled.storeRelease(0);
+        return id;
+    }
+
+    int node = 0;
+
+    for (const auto &c: pattern) {
+        const ushort key = fold(c);
+        int child = next(node, key);
+
+        if (child < 0) {
+            child = _nodes.size();
+            _nodes.push_back(Node());
+            _nodes[node].children.push_back(child);
+            _edges.insert(edgeKey(node, key), child);
+        }
+
+        node = child;
+    }
+
+    _nodes[node].own.push_back(id);
+    _compiled.storeRelease(0);
+
+    return id;
+}
+
+void PathMatcher::compile() const {
+    if (_compiled.loadAcquire()) {
+        return;
+    }
+
+    QMutexLocker locker(&_compileLock.mutex);
+    if (_compiled.loadAcquire()) {
+        return;
+    }
+
+    // the chars of edges are needed for the fail links, the edges are listed once.
+    QHash<int, ushort> chars;
+    chars.reserve(_edges.size());
+
+    for (auto it = _edges.cbegin(); it != _edges.cend(); ++it) {
+        chars.insert(it.value(), static_cast<ushort>(it.key() & 0xFFFF));
+    }
+
+    // the breadth-first order, the fail node is always processed before the node.
+    QVector<int> queue;
+    queue.reserve(_nodes.size());
+
+    _nodes[0].fail = 0;
+    _nodes[0].matches = _nodes[0].own;
+
+    for (int child: _nodes[0].children) {
+        _nodes[child].fail = 0;
+        queue.push_back(child);
+    }
+
+    for (int i = 0; i < queue.size(); ++i) {
+        const int node = queue[i];
+        auto &current = _nodes[node];
+
+        current.matches = current.own + _nodes[current.fail].matches;
+
+        for (int child: current.children) {
+            const ushort c = chars.value(child);
+            int fail = current.fail;
+            int target = next(fail, c);
+
+            while (target < 0 && fail) {
+                fail = _nodes[fail].fail;
+                target = next(fail, c);
+            }
+
+            _nodes[child].fail = (target < 0)? 0: target;
+            queue.push_back(child);
+        }
+    }
+
+    _compiled.storeRelease(1);
+}
+
+int PathMatcher::addPattern(const QString &pattern, bool prefix) {
+    return insert(pattern, prefix);
+}
+
+void PathMatcher::addPatterns(const QStringList &patterns) {
+    for (const auto &pattern: patterns) {
+        insert(pattern, false);
+    }
+}
+
+bool PathMatcher::match(const QString &path, QVector<int> *ids) const {
+    compile();
+
+    if (ids) {
+        ids->clear();
+        *ids += _empty;
+    } else if (_empty.size()) {
+        return true;
+    }
+
+    int node = 0;
+
+    for (int i = 0; i < path.size(); ++i) {
+        const ushort c = fold(path.at(i));
+        int target = next(node, c);
+
+        while (target < 0 && node) {
+            node = _nodes[node].fail;
+            target = next(node, c);
+        }
+
+        node = (target < 0)? 0: target;
+
+        for (int id: _nodes[node].matches) {
+            const auto &pattern = _patterns[id];
+
+            if (pattern.prefix && pattern.size != i + 1) {
+                continue;
+            }
+
+            if (!ids) {
+                return true;
+            }
+
+            ids->push_back(id);
+        }
+    }
+
+    if (!ids) {
+        return false;
+    }
+
+    std::sort(ids->begin(), ids->end());
+    ids->erase(std::unique(ids->begin(), ids->end()), ids->end());
+
+    return ids->size();
+}
+
+int PathMatcher::find(const QString &path) const {
+    QVector<int> ids;
+
+    if (!match(path, &ids)) {
+        return -1;
+    }
+
+    return ids.first();
+}
+
+int PathMatcher::size() const {
+    return _patterns.size();
+}
+
+bool PathMatcher::isEmpty() const {
+    return _patterns.isEmpty();
+}
+
+void PathMatcher::clear() {
+    _nodes.clear();
+    _patterns.clear();
+    _empty.clear();
+    _edges.clear();
+
+    // the root node.
+    _nodes.push_back(Node());
+    _compiled.storeRelease(0);
+}
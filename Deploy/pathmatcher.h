@@ -0,0 +1,109 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef PATHMATCHER_H
+#define PATHMATCHER_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <QVector>
+#include "deploy_global.h"
+
+/**
+ * @brief The PathMatcher class - finds all substring and prefix patterns in the path by one pass.
+ * Patterns are compiled into the Aho-Corasick automaton at the first match after adding,
+ * the case of patterns is folded once while adding and the case of path is folded char by char while matching.
+ * The id of pattern is the order of adding. The empty pattern matches any path.
+ * The match methods are const and can be called from many threads.
+ */
+class DEPLOYSHARED_EXPORT PathMatcher
+{
+public:
+    explicit PathMatcher(Qt::CaseSensitivity cs = Qt::CaseSensitive);
+    PathMatcher(const QStringList& patterns, Qt::CaseSensitivity cs = Qt::CaseSensitive);
+
+    /**
+     * @brief addPattern - add pattern, the automaton is recompiled at the next match.
+     * @param prefix - if true the pattern matches only the begin of path.
+     * @return id of pattern.
+     */
+    int addPattern(const QString& pattern, bool prefix = false);
+
+    /**
+     * @brief addPatterns - add substring patterns.
+     */
+    void addPatterns(const QStringList& patterns);
+
+    /**
+     * @brief match
+     * @param ids - sorted ids of all matched patterns, the search is stopped at the first match if it is nullptr.
+     * @return true if path contains any pattern.
+     */
+    bool match(const QString& path, QVector<int>* ids = nullptr) const;
+
+    /**
+     * @brief find
+     * @return the least id of matched patterns or -1.
+     */
+    int find(const QString& path) const;
+
+    int size() const;
+    bool isEmpty() const;
+    void clear();
+
+private:
+    struct Node {
+        int fail = 0;
+        QVector<int> children;
+
+        /// patterns that end in this node.
+        QVector<int> own;
+
+        /// own patterns and patterns of the fail links.
+        QVector<int> matches;
+    };
+
+    struct Pattern {
+        int size = 0;
+        bool prefix = false;
+    };
+
+    /**
+     * @brief The CompileLock struct - the mutex of lazy compile, the copy of matcher gets own mutex.
+     */
+    struct CompileLock {
+        CompileLock() = default;
+        CompileLock(const CompileLock&) {}
+        CompileLock& operator=(const CompileLock&) { return *this; }
+
+        QMutex mutex;
+    };
+
+    int insert(const QString& pattern, bool prefix);
+
+    /**
+     * @brief compile - build the fail links if patterns were added after the last compile.
+     */
+    void compile() const;
+    int next(int node, ushort c) const;
+    ushort fold(QChar c) const;
+
+    Qt::CaseSensitivity _cs;
+    mutable QVector<Node> _nodes;
+    QVector<Pattern> _patterns;
+    QVector<int> _empty;
+
+    /// (node << 16 | char) to the child node.
+    QHash<quint64, int> _edges;
+
+    mutable QAtomicInt _compiled;
+    mutable CompileLock _compileLock;
+};
+
+#endif // PATHMATCHER_H
@@ -6,11 +6,13 @@
  */
 
 #include "pe.h"
+#include "mappedpe.h"
 
 #include <QFile>
 #include <QFileInfo>
 #include <QSet>
 #include <QVector>
+#include <QtEndian>
 #include <parser-library/parse.h>
 #include <quasarapp.h>
 
@@ -109,7 +111,83 @@ PE::PE(): IGetLibInfo () {
 
 }
 
+Platform PE::probePlatform(const QString &lib) const {
+    QFile file(lib);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return UnknownPlatform;
+    }
+
+    auto dosHeader = file.read(64);
+
+    if (dosHeader.size() != 64 || !dosHeader.startsWith("MZ")) {
+        return UnknownPlatform;
+    }
+
+    // signature (4 bytes), COFF header (20 bytes) and magic of the optional header (2 bytes).
+    auto ntOffset = qFromLittleEndian<quint32>(dosHeader.constData() + 0x3C);
+
+    if (!file.seek(ntOffset)) {
+        return UnknownPlatform;
+    }
+
+    auto ntHeader = file.read(26);
+
+    if (ntHeader.size() != 26 || !ntHeader.startsWith(QByteArray("PE\0\0", 4))) {
+        return UnknownPlatform;
+    }
+
+    auto magic = qFromLittleEndian<quint16>(ntHeader.constData() + 24);
+
+    if (magic == MappedPe::MagicPE32) {
+        return Win32;
+    }
+
+    if (magic == MappedPe::MagicPE32Plus) {
+        return Win64;
+    }
+
+    return UnknownPlatform;
+}
+
 bool PE::getLibInfo(const QString &lib, LibInfo &info) const {
+    MappedPe pe(lib);
+
+    if (!pe.open() || !pe.readImports()) {
+        QuasarAppUtils::Params::verboseLog("Failed to read the import tables of " + lib +
+                                           ", the full PE parser will be used",
+                                           QuasarAppUtils::Info);
+        info.clear();
+        return getLibInfoFull(lib, info);
+    }
+
+    if (pe.magic() == MappedPe::MagicPE32) {
+        info.setPlatform(Platform::Win32);
+    } else if (pe.magic() == MappedPe::MagicPE32Plus) {
+        info.setPlatform(Platform::Win64);
+    } else {
+        info.setPlatform(Platform::UnknownPlatform);
+    }
+
+    QFileInfo fileInfo(lib);
+    info.setName(fileInfo.fileName());
+    info.setPath(fileInfo.absolutePath());
+    info.setWinApi(getAPIModule(info.getName()));
+
+    // the names of modules are upper case like in the full parser.
+    // the delay imports are not dependencies, the full parser does not report them too.
+    for (const char* module : pe.imports()) {
+        info.addDependncies(QString::fromLatin1(module).toUpper());
+    }
+
+    if (info.getWinApi() != WinAPI::NoWinAPI) {
+        info.addDependncies(_winAPI.value(info.getWinApi()));
+    }
+
+    return info.isValid();
+}
+
+bool PE::getLibInfoFull(const QString &lib, LibInfo &info) const {
     auto parsedPeLib = peparse::ParsePEFromFile(lib.toLatin1());
 
     if (!parsedPeLib)
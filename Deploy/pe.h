@@ -29,6 +29,12 @@ class PE : public IGetLibInfo {
 private:
 
     bool getDep(peparse::parsed_pe_internal *, LibInfo &res) const;
+
+    /**
+     * @brief getLibInfoFull - parse all file with the pe-parse library.
+     *  Used only if the import tables can not be read by the MappedPe.
+     */
+    bool getLibInfoFull(const QString& lib, LibInfo& info) const;
     QHash<WinAPI, QSet<QString>> _winAPI;
 
 public:
@@ -43,6 +49,7 @@ public:
     WinAPI getAPIModule(const QString &libName) const;
 
     bool getLibInfo(const QString& lib, LibInfo& info) const override;
+    Platform probePlatform(const QString& lib) const override;
 
     ~PE() override;
 
@@ -6,42 +6,15 @@
  */
 
 #include "qml.h"
+#include "qmlimportparser.h"
 
 #include <QDir>
 #include <QFile>
+#include <QtConcurrent>
 #include <quasarapp.h>
 
 QStringList QML::extractImportsFromFile(const QString &filepath) {
-    QStringList imports;
-    QFile F(filepath);
-    if (!F.open(QIODevice::ReadOnly)) return QStringList();
-
-    QString content = F.readAll();
-    content.remove(QRegExp("\\{(.*)\\}"));
-    content.remove(QRegExp("/\\*(.*)\\*/"));
-
-    for (const QString &line : content.split("\n"))
-        for (QString &word : line.split(";", QString::SkipEmptyParts))
-        {
-            word = word.simplified();
-            if (word.startsWith("//")) continue;
-            if (!word.startsWith("import")) continue;
-
-            QStringList list = word.split(" ", QString::SkipEmptyParts);
-            if (list.count() != 3)
-            {
-                if (list.count() == 5)
-                {
-                    if (list[3] != "as") continue;
-                }
-                else
-                    continue;
-            }
-
-            imports << (list[2][0] + "#" + list[1].replace(".", "/"));
-        }
-
-    return imports;
+    return QmlImportParser::importsOfFile(filepath);
 }
 
 bool QML::extractImportsFromDir(const QString &path, bool recursive) {
@@ -51,22 +24,45 @@ bool QML::extractImportsFromDir(const QString &path, bool recursive) {
         return false;
     }
 
-    auto files = dir.entryInfoList(QStringList() << "*.qml" << "*.QML", QDir::Files);
-    auto dirs = dir.entryInfoList(QDir::NoDotAndDotDot | QDir::Dirs);
+    QStringList dirs = {dir.absolutePath()};
+    QSet<QString> listedDirs;
+
+    // each wave lists dirs serially and parses all found files in parallel,
+    // the dirs of new imports are scanned by the next wave.
+    while (dirs.size()) {
+        QStringList files;
 
-    for (const auto &info: files) {
-        auto imports = extractImportsFromFile(info.absoluteFilePath());
-        for (auto import : imports) {
-            if (!_imports.contains(import)) {
-                _imports.insert(import);
-                extractImportsFromDir(getPathFromImport(import), recursive);
+        while (dirs.size()) {
+            auto current = dirs.takeLast();
+
+            if (listedDirs.contains(current)) {
+                continue;
+            }
+
+            listedDirs.insert(current);
+            QDir currentDir(current);
+
+            for (const auto &info: currentDir.entryInfoList(QStringList() << "*.qml" << "*.QML", QDir::Files)) {
+                files.push_back(info.absoluteFilePath());
+            }
+
+            if (recursive) {
+                for (const auto &info: currentDir.entryInfoList(QDir::NoDotAndDotDot | QDir::Dirs)) {
+                    dirs.push_back(info.absoluteFilePath());
+                }
             }
         }
-    }
 
-    if (recursive) {
-        for (const auto &info: dirs) {
-            extractImportsFromDir(info.absoluteFilePath(), recursive);
+        std::function<QStringList(const QString &)> parse = [](const QString &file) {
+            return QmlImportParser::importsOfFile(file);
+        };
+
+        auto results = QtConcurrent::blockingMapped<QList<QStringList>>(files, parse);
+
+        for (const auto &imports: results) {
+            for (const auto &import : imports) {
+                addImport(import, dirs);
+            }
         }
     }
 
@@ -74,33 +70,16 @@ bool QML::extractImportsFromDir(const QString &path, bool recursive) {
 }
 
 QString QML::getPathFromImport(const QString &import) {
-    auto importData = import.split("#");
-
-    int index;
-
-    if (importData.size() == 2)
-        index = 1;
-    else if (!importData.isEmpty()) {
-        index = 0;
-    } else {
-        return "";
-    }
-
-    auto words = importData.value(index).split(QRegExp("[/\\\\]"));
-
-    bool isSecond = importData.first() == "2";
-
-    QString path;
-    for (auto i = words.rbegin(); i != words.rend(); ++i) {
-        QString word = *i;
-        if (isSecond && secondVersions.contains(word)) {
-            isSecond = false;
-            word.push_back(".2");
+    if (_index) {
+        if (auto module = _index->find(import)) {
+            return module->path;
         }
-
-        path.push_front(word + "/");
     }
 
+    // the module without qmldir file.
+    auto importData = import.split("#");
+    auto path = importData.last().split(QRegExp("[/\\\\]")).join("/");
+
     return QFileInfo(_qmlRoot + "/" + path).absoluteFilePath();
 }
 
@@ -122,39 +101,44 @@ bool QML::deployPath(const QString &path, QStringList &res) {
     return true;
 }
 
-bool QML::scanQmlTree(const QString &qmlTree) {
-    QDir dir(qmlTree);
+void QML::addImport(const QString &import, QStringList &dirs) {
+    QStringList queue = {import};
 
-    if (!dir.isReadable()) {
-        return false;
-    }
+    while (queue.size()) {
+        auto current = queue.takeLast();
 
-    auto list = dir.entryInfoList( QDir::Dirs | QDir::NoDotAndDotDot);
+        if (_imports.contains(current)) {
+            continue;
+        }
 
-    for (const auto &info : list) {
-        if (info.fileName().contains(".2")) {
-            secondVersions.insert(info.fileName().left(info.fileName().size() - 2));
+        _imports.insert(current);
+        dirs.push_back(getPathFromImport(current));
+
+        if (!_index) {
+            continue;
         }
-        scanQmlTree(info.absoluteFilePath());
 
+        if (auto module = _index->find(current)) {
+            queue.append(module->depends);
+        }
     }
-
-    return true;
 }
 
-void QML::addImport() {
+QML::QML(const QString &qmlRoot) {
+    _qmlRoot = qmlRoot;
 
 }
 
-QML::QML(const QString &qmlRoot) {
+QML::QML(const QString &qmlRoot, const QmlModuleIndex *index) {
     _qmlRoot = qmlRoot;
-
+    _index = index;
 }
 
 bool QML::scan(QStringList &res, const QString& _qmlProjectDir) {
 
-    if (!scanQmlTree(_qmlRoot)) {
-        return false;
+    if (!_index) {
+        _ownIndex.build(_qmlRoot);
+        _index = &_ownIndex;
     }
 
     if (!extractImportsFromDir(_qmlProjectDir, true)) {
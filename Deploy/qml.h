@@ -11,6 +11,7 @@
 #include <QSet>
 #include <QStringList>
 #include "deploy_global.h"
+#include "qmlmoduleindex.h"
 
 class DEPLOYSHARED_EXPORT QML {
 private:
@@ -18,15 +19,27 @@ private:
     bool extractImportsFromDir(const QString &path, bool recursive = false);
     QString getPathFromImport(const QString& import);
     bool deployPath( const QString& path, QStringList& res);
-    bool scanQmlTree(const QString& qmlTree);
-    void addImport();
+
+    /**
+     * @brief addImport - add import and the modules of its depends and import lines.
+     * @param dirs - dirs of new modules, they should be scanned for imports.
+     */
+    void addImport(const QString& import, QStringList& dirs);
     QString _qmlRoot = "";
     QSet<QString> _imports;
-    QSet<QString> secondVersions;
+
+    QmlModuleIndex _ownIndex;
+    const QmlModuleIndex* _index = nullptr;
 
 public:
     QML(const QString& qmlRoot);
 
+    /**
+     * @brief QML
+     * @param index - prebuilt index of the qml dir, it should be valid while the scaner is used.
+     */
+    QML(const QString& qmlRoot, const QmlModuleIndex* index);
+
     bool scan(QStringList &res, const QString &_qmlProjectDir);
 
     friend class deploytest;
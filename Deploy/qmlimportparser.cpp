@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "qmlimportparser.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+
+#define READ_CHUNK_SIZE 4096
+
+namespace {
+
+enum class TokenType {
+    End,
+    Newline,
+    Identifier,
+    Number,
+    String,
+    Symbol
+};
+
+struct Token {
+    TokenType type = TokenType::End;
+    QByteArray text;
+
+    bool is(TokenType tokenType, const char* value) const {
+        return type == tokenType && text == value;
+    }
+
+    bool isStatementEnd() const {
+        return type == TokenType::End || type == TokenType::Newline ||
+                is(TokenType::Symbol, ";");
+    }
+};
+
+/**
+ * @brief The QmlLexer class - tokenizer of the qml source, reads the device by chunks.
+ */
+class QmlLexer
+{
+public:
+    explicit QmlLexer(QIODevice* device):
+        _device(device) {
+    }
+
+    Token next();
+
+private:
+    int peek();
+    int get();
+    bool refill();
+
+    Token make(TokenType type, const QByteArray& text = QByteArray()) const;
+    void readString(int quote, QByteArray& text);
+
+    QIODevice* _device = nullptr;
+    QByteArray _buffer;
+    int _pos = 0;
+};
+
+struct CacheItem {
+    qint64 size = 0;
+    qint64 mtime = 0;
+    QStringList imports;
+};
+
+}
+
+static QMutex cacheLock;
+static QHash<QString, CacheItem> importsCache;
+
+static bool isIdentifierStart(int c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+            c == '_' || c == '$' || c >= 0x80;
+}
+
+static bool isDigit(int c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool isIdentifierChar(int c) {
+    return isIdentifierStart(c) || isDigit(c);
+}
+
+bool QmlLexer::refill() {
+    if (!_device) {
+        return false;
+    }
+
+    auto chunk = _device->read(READ_CHUNK_SIZE);
+
+    if (chunk.isEmpty()) {
+        return false;
+    }
+
+    _buffer = _buffer.mid(_pos) + chunk;
+    _pos = 0;
+
+    return true;
+}
+
+int QmlLexer::peek() {
+    if (_pos >= _buffer.size() && !refill()) {
+        return -1;
+    }
+
+    return static_cast<uchar>(_buffer.at(_pos));
+}
+
+int QmlLexer::get() {
+    int c = peek();
+
+    if (c >= 0) {
+        ++_pos;
+    }
+
+    return c;
+}
+
+Token QmlLexer::make(TokenType type, const QByteArray &text) const {
+    Token token;
+    token.type = type;
+    token.text = text;
+
+    return token;
+}
+
+void QmlLexer::readString(int quote, QByteArray &text) {
+    int c;
+
+    while ((c = get()) >= 0 && c != quote) {
+        // the escaped char can be the quote.
+        if (c == '\\') {
+            c = get();
+
+            if (c < 0) {
+                return;
+            }
+        }
+
+        text.push_back(static_cast<char>(c));
+    }
+}
+
+Token QmlLexer::next() {
+    while (true) {
+        int c = get();
+
+        if (c < 0) {
+            return make(TokenType::End);
+        }
+
+        if (c == '\n') {
+            return make(TokenType::Newline);
+        }
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+            continue;
+        }
+
+        if (c == '/' && peek() == '/') {
+            while ((c = get()) >= 0 && c != '\n') {}
+
+            return make((c < 0)? TokenType::End: TokenType::Newline);
+        }
+
+        if (c == '/' && peek() == '*') {
+            get();
+            bool newline = false;
+
+            while (true) {
+                c = get();
+
+                if (c < 0) {
+                    return make(TokenType::End);
+                }
+
+                if (c == '\n') {
+                    newline = true;
+                } else if (c == '*' && peek() == '/') {
+                    get();
+                    break;
+                }
+            }
+
+            // the multiline comment separates statements like the end of line.
+            if (newline) {
+                return make(TokenType::Newline);
+            }
+
+            continue;
+        }
+
+        QByteArray text;
+
+        if (c == '"' || c == '\'') {
+            readString(c, text);
+            return make(TokenType::String, text);
+        }
+
+        text.push_back(static_cast<char>(c));
+
+        if (isIdentifierStart(c)) {
+            while (isIdentifierChar(peek())) {
+                text.push_back(static_cast<char>(get()));
+            }
+
+            return make(TokenType::Identifier, text);
+        }
+
+        if (isDigit(c)) {
+            while (isDigit(peek()) || peek() == '.') {
+                text.push_back(static_cast<char>(get()));
+            }
+
+            return make(TokenType::Number, text);
+        }
+
+        return make(TokenType::Symbol, text);
+    }
+}
+
+static Token skipStatement(QmlLexer &lexer, Token token) {
+    while (!token.isStatementEnd()) {
+        token = lexer.next();
+    }
+
+    return token;
+}
+
+QStringList QmlImportParser::parse(QIODevice *device) {
+    QStringList imports;
+    QmlLexer lexer(device);
+
+    Token token = lexer.next();
+
+    while (token.type != TokenType::End) {
+        if (token.isStatementEnd()) {
+            token = lexer.next();
+            continue;
+        }
+
+        if (token.is(TokenType::Identifier, "pragma")) {
+            token = skipStatement(lexer, lexer.next());
+            continue;
+        }
+
+        // the imports can be only before the first object declaration.
+        if (!token.is(TokenType::Identifier, "import")) {
+            break;
+        }
+
+        token = lexer.next();
+
+        // the directory or javascript import.
+        if (token.type != TokenType::Identifier) {
+            token = skipStatement(lexer, token);
+            continue;
+        }
+
+        QByteArray uri = token.text;
+        token = lexer.next();
+
+        while (token.is(TokenType::Symbol, ".")) {
+            token = lexer.next();
+
+            if (token.type != TokenType::Identifier) {
+                break;
+            }
+
+            uri += "/" + token.text;
+            token = lexer.next();
+        }
+
+        QByteArray major;
+
+        if (token.type == TokenType::Number) {
+            major = token.text.left(token.text.indexOf('.'));
+            token = lexer.next();
+        }
+
+        imports.push_back(QString::fromUtf8(major + "#" + uri));
+
+        // the rest of statement is the "as Qualifier" part.
+        token = skipStatement(lexer, token);
+    }
+
+    return imports;
+}
+
+QStringList QmlImportParser::parse(const QByteArray &content) {
+    QByteArray data = content;
+    QBuffer buffer(&data);
+
+    if (!buffer.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    return parse(&buffer);
+}
+
+QStringList QmlImportParser::importsOfFile(const QString &file) {
+    QFileInfo info(file);
+    const auto key = info.absoluteFilePath();
+    const auto size = info.size();
+    const auto mtime = info.lastModified().toMSecsSinceEpoch();
+
+    {
+        QMutexLocker locker(&cacheLock);
+        auto it = importsCache.constFind(key);
+
+        if (it != importsCache.constEnd() && it->size == size && it->mtime == mtime) {
+            return it->imports;
+        }
+    }
+
+    QFile source(key);
+
+    if (!source.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    CacheItem item;
+    item.size = size;
+    item.mtime = mtime;
+    item.imports = parse(&source);
+
+    QMutexLocker locker(&cacheLock);
+    importsCache.insert(key, item);
+
+    return item.imports;
+}
+
+void QmlImportParser::clearCache() {
+    QMutexLocker locker(&cacheLock);
+    importsCache.clear();
+}
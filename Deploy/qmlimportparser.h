@@ -0,0 +1,50 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef QMLIMPORTPARSER_H
+#define QMLIMPORTPARSER_H
+
+#include <QStringList>
+#include "deploy_global.h"
+
+class QIODevice;
+
+/**
+ * @brief The QmlImportParser class - single pass tokenizer of the import statements of qml files.
+ * The file is read by small chunks and the reading is stopped at the first object declaration,
+ * so only the header of file is read. Comments and strings are skipped,
+ * the directory and javascript imports (import "path") are ignored.
+ * Imports are returned in format "major#Module/Path" (for example 2#QtQuick/Controls),
+ * the major of versionless import is empty (#QtQuick).
+ */
+class DEPLOYSHARED_EXPORT QmlImportParser
+{
+public:
+    /**
+     * @brief parse - read imports from the device.
+     */
+    static QStringList parse(QIODevice* device);
+
+    /**
+     * @brief parse - read imports from the qml source.
+     */
+    static QStringList parse(const QByteArray& content);
+
+    /**
+     * @brief importsOfFile - imports of file from the cache or from the file.
+     *  The cache item is valid while the size and the modification time of file are not changed.
+     *  This method is thread safe.
+     */
+    static QStringList importsOfFile(const QString& file);
+
+    /**
+     * @brief clearCache - remove all items of the cache.
+     */
+    static void clearCache();
+};
+
+#endif // QMLIMPORTPARSER_H
@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "qmlmoduleindex.h"
+#include "deploycore.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTextStream>
+
+#define QML_INDEX_MAGIC   0x4d515143 // CQQM
+#define QML_INDEX_VERSION 1
+
+QmlModuleIndex::QmlModuleIndex() {
+
+}
+
+static QString importKey(int major, const QString& uri) {
+    return ((major >= 0)? QString::number(major): QString()) + "#" + uri;
+}
+
+/**
+ * @brief moduleImport - convert the module and the version of the qmldir line to the import.
+ * @param moduleMajor - major of module of qmldir, it is used for the "auto" version.
+ */
+static QString moduleImport(const QStringList& words, int index, int moduleMajor) {
+    QString uri = words.value(index);
+    uri.replace('.', '/');
+
+    const QString version = words.value(index + 1);
+
+    if (version == "auto") {
+        return importKey(moduleMajor, uri);
+    }
+
+    bool ok = false;
+    int major = version.section('.', 0, 0).toInt(&ok);
+
+    return importKey((ok)? major: -1, uri);
+}
+
+bool QmlModuleIndex::parseQmldir(const QString &qmldir, QmlModule &module) const {
+    QFile file(qmldir);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QFileInfo info(qmldir);
+    module.path = info.absolutePath();
+
+    // the versioned dir can be any part of path (QtQuick.2 or QtQuick/Controls.2/impl).
+    static const QRegularExpression versioned("^(.+)\\.(\\d+)(\\.\\d+)?$");
+    QStringList uriParts;
+
+    const auto relative = QDir(_qmlRoot).relativeFilePath(module.path);
+    for (const auto &part: relative.split('/', QString::SkipEmptyParts)) {
+        auto match = versioned.match(part);
+
+        if (match.hasMatch()) {
+            uriParts.push_back(match.captured(1));
+            module.major = match.captured(2).toInt();
+        } else {
+            uriParts.push_back(part);
+        }
+    }
+
+    module.uri = uriParts.join('/');
+
+    QTextStream stream(&file);
+    QString line;
+
+    while (stream.readLineInto(&line)) {
+        auto words = line.simplified().split(' ', QString::SkipEmptyParts);
+
+        if (words.isEmpty() || words.first().startsWith('#')) {
+            continue;
+        }
+
+        // qt6 import modifiers.
+        if (words.first() == "optional" || words.first() == "default") {
+            words.removeFirst();
+        }
+
+        const auto &command = words.value(0);
+
+        if (command == "module" && words.size() > 1) {
+            module.uri = words[1];
+            module.uri.replace('.', '/');
+
+        } else if (command == "plugin" && words.size() > 1) {
+            module.plugins.push_back(words[1]);
+
+        } else if ((command == "depends" || command == "import") && words.size() > 1) {
+            module.depends.push_back(moduleImport(words, 1, module.major));
+        }
+    }
+
+    return !module.uri.isEmpty();
+}
+
+void QmlModuleIndex::addModule(const QmlModule &module) {
+    const auto key = importKey(module.major, module.uri);
+
+    if (_index.contains(key)) {
+        return;
+    }
+
+    const int id = _modules.size();
+    _modules.push_back(module);
+    _index.insert(key, id);
+
+    if (module.major >= 0) {
+        auto latest = _latest.constFind(module.uri);
+
+        if (latest == _latest.constEnd() || _modules[latest.value()].major < module.major) {
+            _latest.insert(module.uri, id);
+        }
+    }
+}
+
+void QmlModuleIndex::build(const QString &qmlRoot) {
+    clear();
+
+    _qmlRoot = QFileInfo(qmlRoot).absoluteFilePath();
+    _fingerprint = makeFingerprint(_qmlRoot);
+
+    QDirIterator it(_qmlRoot, QStringList() << "qmldir", QDir::Files, QDirIterator::Subdirectories);
+
+    while (it.hasNext()) {
+        QmlModule module;
+
+        if (parseQmldir(it.next(), module)) {
+            addModule(module);
+        }
+    }
+}
+
+const QmlModule *QmlModuleIndex::find(const QString &import) const {
+    QString normalized = import;
+    normalized.replace('\\', '/');
+
+    const int separator = normalized.indexOf('#');
+    const QString major = (separator >= 0)? normalized.left(separator): QString();
+    const QString uri = normalized.mid(separator + 1);
+
+    int id = -1;
+
+    if (major.size()) {
+        id = _index.value(major + "#" + uri, -1);
+    }
+
+    if (id < 0) {
+        id = _index.value("#" + uri, -1);
+    }
+
+    if (id < 0 && major.isEmpty()) {
+        id = _latest.value(uri, -1);
+    }
+
+    if (id < 0) {
+        return nullptr;
+    }
+
+    return &_modules.at(id);
+}
+
+QStringList QmlModuleIndex::resolve(const QStringList &imports) const {
+    QStringList result;
+    QSet<const QmlModule*> visited;
+    QStringList queue = imports;
+
+    while (queue.size()) {
+        auto module = find(queue.takeLast());
+
+        if (!module || visited.contains(module)) {
+            continue;
+        }
+
+        visited.insert(module);
+        result.push_back(module->path);
+        queue.append(module->depends);
+    }
+
+    return result;
+}
+
+const QVector<QmlModule> &QmlModuleIndex::modules() const {
+    return _modules;
+}
+
+const QString &QmlModuleIndex::qmlRoot() const {
+    return _qmlRoot;
+}
+
+int QmlModuleIndex::size() const {
+    return _modules.size();
+}
+
+void QmlModuleIndex::clear() {
+    _qmlRoot.clear();
+    _fingerprint.clear();
+    _modules.clear();
+    _index.clear();
+    _latest.clear();
+}
+
+QString QmlModuleIndex::indexFile(const QString &qmlRoot) {
+    auto key = QCryptographicHash::hash(QFileInfo(qmlRoot).absoluteFilePath().toUtf8(),
+                                        QCryptographicHash::Sha1).toHex();
+
+    return DeployCore::getCacheDir() + "/qmlmodules/" + key + ".index";
+}
+
+QByteArray QmlModuleIndex::makeFingerprint(const QString &qmlRoot) {
+    QFileInfo root(qmlRoot);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(root.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(root.lastModified().toMSecsSinceEpoch()));
+
+    // the modules are installed and removed as the child dirs of the qml dir.
+    auto list = QDir(qmlRoot).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const auto &dir: list) {
+        hash.addData(dir.fileName().toUtf8());
+        hash.addData(QByteArray::number(dir.lastModified().toMSecsSinceEpoch()));
+    }
+
+    return hash.result();
+}
+
+bool QmlModuleIndex::load(const QString &file, const QByteArray &fingerprint) {
+    clear();
+
+    QFile index(file);
+
+    if (!index.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&index);
+
+    quint32 magic, version;
+    stream >> magic >> version;
+
+    if (magic != QML_INDEX_MAGIC || version != QML_INDEX_VERSION) {
+        return false;
+    }
+
+    QByteArray savedFingerprint;
+    stream >> savedFingerprint;
+
+    if (savedFingerprint != fingerprint) {
+        return false;
+    }
+
+    quint32 count = 0;
+    stream >> _qmlRoot >> count;
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QmlModule module;
+        qint32 major;
+
+        stream >> module.uri >> major >> module.path >> module.plugins >> module.depends;
+        module.major = major;
+
+        addModule(module);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        clear();
+        return false;
+    }
+
+    _fingerprint = savedFingerprint;
+
+    return true;
+}
+
+bool QmlModuleIndex::save(const QString &file) const {
+    QDir().mkpath(QFileInfo(file).absolutePath());
+
+    QFile index(file);
+
+    if (!index.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QDataStream stream(&index);
+    stream << static_cast<quint32>(QML_INDEX_MAGIC)
+           << static_cast<quint32>(QML_INDEX_VERSION)
+           << _fingerprint
+           << _qmlRoot
+           << static_cast<quint32>(_modules.size());
+
+    for (const auto &module: _modules) {
+        stream << module.uri
+               << static_cast<qint32>(module.major)
+               << module.path
+               << module.plugins
+               << module.depends;
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
@@ -0,0 +1,108 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef QMLMODULEINDEX_H
+#define QMLMODULEINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include "deploy_global.h"
+
+/**
+ * @brief The QmlModule struct - one module of the qml dir of Qt, it is described by the qmldir file.
+ * Imports are stored in format of QmlImportParser ("major#Module/Path").
+ */
+struct DEPLOYSHARED_EXPORT QmlModule {
+    /// uri of module in import format (QtQuick/Controls).
+    QString uri;
+
+    /// major version of the versioned dir (Controls.2), -1 if the dir is not versioned.
+    int major = -1;
+
+    /// absolute path of the dir of module.
+    QString path;
+
+    /// names of the plugin libraries (plugin lines).
+    QStringList plugins;
+
+    /// modules of the depends and import lines.
+    QStringList depends;
+};
+
+/**
+ * @brief The QmlModuleIndex class - index of all modules of the qml dir of Qt.
+ * The index is built by one walk over the qml dir, each qmldir file is one module.
+ * Import is resolved like the qml engine resolves it: the versioned dir (Module.2) of the major version
+ * and then the not versioned dir. The versionless import is resolved to the not versioned dir
+ * or to the dir of the latest major version.
+ * The index can be saved into file and loaded while the qml dir is not changed.
+ */
+class DEPLOYSHARED_EXPORT QmlModuleIndex
+{
+public:
+    QmlModuleIndex();
+
+    /**
+     * @brief build - parse all qmldir files of the qmlRoot.
+     */
+    void build(const QString& qmlRoot);
+
+    /**
+     * @brief find - module of import.
+     * @param import - import in format "major#Module/Path".
+     * @return nullptr if the module not exists in the index.
+     */
+    const QmlModule* find(const QString& import) const;
+
+    /**
+     * @brief resolve - modules of imports and all modules of their depends and import lines.
+     * @return paths of modules dirs.
+     */
+    QStringList resolve(const QStringList& imports) const;
+
+    const QVector<QmlModule>& modules() const;
+    const QString& qmlRoot() const;
+    int size() const;
+    void clear();
+
+    /**
+     * @brief indexFile
+     * @return path of the cached index of qmlRoot (it is saved in the cache dir).
+     */
+    static QString indexFile(const QString& qmlRoot);
+
+    /**
+     * @brief makeFingerprint - sha1 of the qml dir path and the modification time of the dir and its child dirs.
+     */
+    static QByteArray makeFingerprint(const QString& qmlRoot);
+
+    /**
+     * @brief load - load index from file.
+     * @param fingerprint - expected fingerprint of the qml dir.
+     * @return true if file is valid index of the same qml dir.
+     */
+    bool load(const QString& file, const QByteArray& fingerprint);
+    bool save(const QString& file) const;
+
+private:
+    bool parseQmldir(const QString& qmldir, QmlModule& module) const;
+    void addModule(const QmlModule& module);
+
+    QString _qmlRoot;
+    QByteArray _fingerprint;
+    QVector<QmlModule> _modules;
+
+    /// "major#uri" of the versioned dirs and "#uri" of the not versioned dirs.
+    QHash<QString, int> _index;
+
+    /// uri of module to the versioned dir with the latest major version.
+    QHash<QString, int> _latest;
+};
+
+#endif // QMLMODULEINDEX_H
@@ -0,0 +1,396 @@
+/*
+ * Copyright (C) 2018-2020 QuasarApp.
+ * Distributed under the lgplv3 software license, see the accompanying
+ * Everyone is permitted to copy and distribute verbatim copies
+ * of this license document, but changing it is not allowed.
+ */
+
+#include "scancache.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <quasarapp.h>
+
+#ifdef Q_OS_LINUX
+#include <sys/stat.h>
+#endif
+
+#define SCAN_CACHE_MAGIC   0x43515343 // CQSC
+#define SCAN_CACHE_VERSION 3
+
+// the items that are not used in this count of runs are removed.
+#define SCAN_CACHE_MAX_UNUSED_RUNS 16
+
+static QDataStream& operator << (QDataStream& stream, const ScanCacheItem& item) {
+    stream << item.size
+           << item.mtime
+           << item.inode
+           << item.flags
+           << item.lastRun
+           << static_cast<qint32>(item.platform)
+           << static_cast<quint8>(item.winApi)
+           << item.qtPath
+           << item.rpath
+           << item.dependencies;
+
+    return stream;
+}
+
+static QDataStream& operator >> (QDataStream& stream, ScanCacheItem& item) {
+    qint32 platform;
+    quint8 winApi;
+
+    stream >> item.size
+           >> item.mtime
+           >> item.inode
+           >> item.flags
+           >> item.lastRun
+           >> platform
+           >> winApi
+           >> item.qtPath
+           >> item.rpath
+           >> item.dependencies;
+
+    item.platform = static_cast<Platform>(platform);
+    item.winApi = static_cast<WinAPI>(winApi);
+
+    return stream;
+}
+
+static QDataStream& operator << (QDataStream& stream, const ScanCacheClosure& closure) {
+    stream << static_cast<quint8>(closure.winApi) << closure.libs;
+    return stream;
+}
+
+static QDataStream& operator >> (QDataStream& stream, ScanCacheClosure& closure) {
+    quint8 winApi;
+    stream >> winApi >> closure.libs;
+    closure.winApi = static_cast<WinAPI>(winApi);
+
+    return stream;
+}
+
+ScanCache::ScanCache() {
+    _cacheFile = DeployCore::getCacheDir() + "/scan.cache";
+}
+
+bool ScanCache::readFingerprint(const QString &file, QString &key, ScanCacheItem &item) const {
+    QFileInfo info(file);
+    key = info.canonicalFilePath();
+
+    if (key.isEmpty()) {
+        return false;
+    }
+
+#ifdef Q_OS_LINUX
+    struct stat st;
+    if (stat(QFile::encodeName(key).constData(), &st) != 0) {
+        return false;
+    }
+
+    item.size = st.st_size;
+    item.mtime = static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    item.inode = st.st_ino;
+#else
+    item.size = info.size();
+    item.mtime = info.lastModified().toMSecsSinceEpoch();
+    item.inode = 0;
+#endif
+
+    return true;
+}
+
+bool ScanCache::isFresh(const QString &file) const {
+    QString key;
+    ScanCacheItem current;
+
+    if (!readFingerprint(file, key, current)) {
+        return false;
+    }
+
+    auto it = _items.constFind(key);
+    if (it == _items.constEnd()) {
+        return false;
+    }
+
+    return it->size == current.size &&
+            it->mtime == current.mtime &&
+            it->inode == current.inode;
+}
+
+void ScanCache::loadIfNeeded() {
+    if (_loaded) {
+        return;
+    }
+
+    if (QuasarAppUtils::Params::isEndable("clearCache")) {
+        QuasarAppUtils::Params::verboseLog("The scan cache is invalidated by clearCache option",
+                                           QuasarAppUtils::Info);
+        invalidate();
+        return;
+    }
+
+    load();
+}
+
+bool ScanCache::find(const QString &file, LibInfo &info) {
+    QString key;
+    ScanCacheItem current;
+
+    bool exists = readFingerprint(file, key, current);
+
+    QMutexLocker locker(&_mutex);
+    loadIfNeeded();
+
+    if (!exists) {
+        _misses++;
+        return false;
+    }
+
+    auto it = _items.find(key);
+
+    if (it == _items.end() ||
+            it->size != current.size ||
+            it->mtime != current.mtime ||
+            it->inode != current.inode) {
+        _misses++;
+        return false;
+    }
+
+    bool checkRPATH = !QuasarAppUtils::Params::isEndable("noCheckRPATH");
+    if (checkRPATH && !(it->flags & RpathChecked)) {
+        _misses++;
+        return false;
+    }
+
+    QFileInfo fileInfo(file);
+
+    info.setName(fileInfo.fileName());
+    info.setPath(fileInfo.absolutePath());
+    info.setPlatform(it->platform);
+    info.setWinApi(it->winApi);
+    info.setRpath(it->rpath);
+    info.setDependncies(QSet<QString>(it->dependencies.begin(), it->dependencies.end()));
+
+    if (checkRPATH) {
+        info.setQtPath(it->qtPath);
+    }
+
+    if (it->lastRun != _run) {
+        it->lastRun = _run;
+        _changed = true;
+    }
+
+    _hits++;
+    return true;
+}
+
+void ScanCache::insert(const QString &file, const LibInfo &info) {
+    // the api-ms-win libraries get dependencies from environment, so do not save them.
+    if (info.getWinApi() != WinAPI::NoWinAPI) {
+        return;
+    }
+
+    QString key;
+    ScanCacheItem item;
+
+    if (!readFingerprint(file, key, item)) {
+        return;
+    }
+
+    if (!QuasarAppUtils::Params::isEndable("noCheckRPATH")) {
+        item.flags |= RpathChecked;
+    }
+
+    item.platform = info.getPlatform();
+    item.winApi = info.getWinApi();
+    item.qtPath = info.getQtPath();
+    item.rpath = info.getRpath();
+    item.dependencies = info.getDependncies().values();
+
+    QMutexLocker locker(&_mutex);
+    loadIfNeeded();
+
+    item.lastRun = _run;
+
+    _items.insert(key, item);
+    _changed = true;
+}
+
+void ScanCache::setContext(const QByteArray &context) {
+    QMutexLocker locker(&_mutex);
+    loadIfNeeded();
+
+    if (_context == context) {
+        return;
+    }
+
+    _context = context;
+    _closures.clear();
+    _changed = true;
+}
+
+bool ScanCache::findClosure(const QString &lib, ScanCacheClosure &closure) {
+    QMutexLocker locker(&_mutex);
+    loadIfNeeded();
+
+    if (_context.isEmpty()) {
+        return false;
+    }
+
+    auto it = _closures.constFind(lib);
+    if (it == _closures.constEnd()) {
+        return false;
+    }
+
+    if (!isFresh(lib)) {
+        return false;
+    }
+
+    for (const auto& dep: it->libs) {
+        if (!isFresh(dep)) {
+            return false;
+        }
+    }
+
+    closure = *it;
+    _closureHits++;
+
+    return true;
+}
+
+void ScanCache::insertClosure(const QString &lib, const ScanCacheClosure &closure) {
+    QMutexLocker locker(&_mutex);
+    loadIfNeeded();
+
+    if (_context.isEmpty()) {
+        return;
+    }
+
+    _closures.insert(lib, closure);
+    _changed = true;
+}
+
+void ScanCache::invalidate() {
+    _loaded = true;
+    _items.clear();
+    _closures.clear();
+    _changed = true;
+}
+
+bool ScanCache::load() {
+    _loaded = true;
+
+    QFile file(_cacheFile);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+
+    quint32 magic, version;
+    stream >> magic >> version;
+
+    if (magic != SCAN_CACHE_MAGIC || version != SCAN_CACHE_VERSION) {
+        QuasarAppUtils::Params::verboseLog("The scan cache " + _cacheFile + " has unsupported format",
+                                           QuasarAppUtils::Warning);
+        return false;
+    }
+
+    stream >> _run >> _items >> _context >> _closures;
+
+    if (stream.status() != QDataStream::Ok) {
+        QuasarAppUtils::Params::verboseLog("The scan cache " + _cacheFile + " is broken",
+                                           QuasarAppUtils::Warning);
+        invalidate();
+        return false;
+    }
+
+    _run++;
+
+    return true;
+}
+
+void ScanCache::prune() {
+    int removed = 0;
+
+    for (auto it = _items.begin(); it != _items.end();) {
+        if (_run - it->lastRun > SCAN_CACHE_MAX_UNUSED_RUNS || !QFileInfo::exists(it.key())) {
+            it = _items.erase(it);
+            removed++;
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = _closures.begin(); it != _closures.end();) {
+        if (!QFileInfo::exists(it.key())) {
+            it = _closures.erase(it);
+            removed++;
+        } else {
+            ++it;
+        }
+    }
+
+    if (removed) {
+        QuasarAppUtils::Params::verboseLog(QString("Removed %0 old items from the scan cache").arg(removed),
+                                           QuasarAppUtils::Info);
+    }
+}
+
+bool ScanCache::save() {
+    if (!_changed) {
+        return true;
+    }
+
+    prune();
+
+    QDir().mkpath(QFileInfo(_cacheFile).absolutePath());
+
+    QFile file(_cacheFile);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QuasarAppUtils::Params::verboseLog("Failed to save the scan cache into " + _cacheFile,
+                                           QuasarAppUtils::Warning);
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << static_cast<quint32>(SCAN_CACHE_MAGIC)
+           << static_cast<quint32>(SCAN_CACHE_VERSION)
+           << _run << _items << _context << _closures;
+
+    file.close();
+    _changed = false;
+
+    return stream.status() == QDataStream::Ok;
+}
+
+int ScanCache::hits() const {
+    return _hits;
+}
+
+int ScanCache::misses() const {
+    return _misses;
+}
+
+int ScanCache::size() const {
+    return _items.size();
+}
+
+int ScanCache::closureHits() const {
+    return _closureHits;
+}
+
+QString ScanCache::getCacheFile() const {
+    return _cacheFile;
+}
+
+void ScanCache::setCacheFile(const QString &cacheFile) {
+    _cacheFile = cacheFile;
+    _loaded = false;
+}
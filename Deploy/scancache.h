@@ -0,0 +1,135 @@
+//#
+//# Copyright (C) 2018-2020 QuasarApp.
+//# Distributed under the lgplv3 software license, see the accompanying
+//# Everyone is permitted to copy and distribute verbatim copies
+//# of this license document, but changing it is not allowed.
+//#
+
+#ifndef SCANCACHE_H
+#define SCANCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include "deploy_global.h"
+#include "libinfo.h"
+
+/**
+ * @brief The ScanCacheItem struct
+ * result of parsing of one binary file and the fingerprint of this file.
+ */
+struct DEPLOYSHARED_EXPORT ScanCacheItem {
+    qint64 size = 0;
+    qint64 mtime = 0;
+    quint64 inode = 0;
+    quint8 flags = 0;
+
+    /// number of the last run that used this item.
+    quint32 lastRun = 0;
+
+    Platform platform = UnknownPlatform;
+    WinAPI winApi = WinAPI::NoWinAPI;
+    QString qtPath;
+    QString rpath;
+    QStringList dependencies;
+};
+
+/**
+ * @brief The ScanCacheClosure struct
+ * the resolved transitive dependencies of a library.
+ */
+struct DEPLOYSHARED_EXPORT ScanCacheClosure {
+    WinAPI winApi = WinAPI::NoWinAPI;
+    QStringList libs;
+};
+
+/**
+ * @brief The ScanCache class - persistent on disk cache of the DependenciesScanner.
+ * Items are keyed by canonical path of file and are valid while the size,
+ * the modification time and the inode of the file are not changed.
+ * Closures are valid only for the same scan context (environment, ignore rules, qt dirs).
+ * The items of removed files and the items that are not used in the last runs are pruned on save.
+ * The find and insert methods are thread safe.
+ */
+class DEPLOYSHARED_EXPORT ScanCache
+{
+public:
+    enum ItemFlags: quint8 {
+        RpathChecked = 0x1
+    };
+
+    ScanCache();
+
+    /**
+     * @brief find - fill info from the cache.
+     * @param file - path to library
+     * @param info - result
+     * @return true if the cache contains a valid item of file.
+     */
+    bool find(const QString& file, LibInfo& info);
+
+    /**
+     * @brief insert - add the parse result of file into cache.
+     */
+    void insert(const QString& file, const LibInfo& info);
+
+    /**
+     * @brief setContext - sets fingerprint of the scan context.
+     *  All closures of other context will be dropped.
+     */
+    void setContext(const QByteArray& context);
+
+    /**
+     * @brief findClosure
+     * @param lib - full path of library
+     * @param closure - result
+     * @return true if the closure of lib exists and all libraries of closure are not changed.
+     */
+    bool findClosure(const QString& lib, ScanCacheClosure& closure);
+    void insertClosure(const QString& lib, const ScanCacheClosure& closure);
+
+    /**
+     * @brief invalidate - removes all items of cache.
+     */
+    void invalidate();
+
+    bool load();
+    bool save();
+
+    int hits() const;
+    int misses() const;
+
+    /**
+     * @brief size
+     * @return count of the parse results of files.
+     */
+    int size() const;
+    int closureHits() const;
+
+    QString getCacheFile() const;
+    void setCacheFile(const QString &cacheFile);
+
+private:
+    bool readFingerprint(const QString& file, QString& key, ScanCacheItem& item) const;
+    bool isFresh(const QString& file) const;
+    void loadIfNeeded();
+    void prune();
+
+    QHash<QString, ScanCacheItem> _items;
+    QHash<QString, ScanCacheClosure> _closures;
+    QByteArray _context;
+
+    /// number of the current run, it is increased on each load.
+    quint32 _run = 0;
+
+    QString _cacheFile;
+    QMutex _mutex;
+    bool _loaded = false;
+    bool _changed = false;
+
+    int _hits = 0;
+    int _misses = 0;
+    int _closureHits = 0;
+};
+
+#endif // SCANCACHE_H
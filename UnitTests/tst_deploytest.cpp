@@ -18,6 +18,18 @@
 #include <pathutils.h>
 #include <dependencymap.h>
 #include <packing.h>
+#include <scancache.h>
+#include <envlibindex.h>
+#include <ldcache.h>
+#include <dependencygraph.h>
+#include <mappedpe.h>
+#include <filecopier.h>
+#include <elfstrip.h>
+#include <mappedelf.h>
+#include <deploymanifest.h>
+#include <qmlimportparser.h>
+#include <qmlmoduleindex.h>
+#include <pathmatcher.h>
 
 #include <QMap>
 #include <QByteArray>
@@ -143,6 +155,50 @@ private slots:
     void testInit();
 
     void testDependencyMap();
+
+    void testScanCache();
+
+    void testRpath();
+
+    void testEnvLibIndex();
+
+    void testLdCache();
+
+    void testScanMany();
+
+    void testDependencyGraph();
+
+    void testMappedPe();
+
+    void testProbePlatform();
+
+    void testParallelCopy();
+
+    void testFileCopier();
+
+    void testIncrementalCompare();
+
+    void testStripDeployed();
+
+    void testElfStrip();
+
+    void testSplitDebug();
+
+    void testDeployManifest();
+
+    void testClear();
+
+    void testKeepSymlinks();
+
+    void testDedup();
+
+    void testQmlImportParser();
+
+    void testQmlModuleIndex();
+
+    void testPeakMemoryUsage();
+
+    void testPathMatcher();
 };
 
 bool deploytest::runProcess(const QString &DistroPath,
@@ -698,6 +754,1062 @@ void deploytest::testDependencyMap() {
 
 }
 
+void deploytest::testScanCache() {
+    LibCreator creator("./");
+
+    // the test changes the libs, so it works with the private copies of the fixture.
+    const QString dir = "./test/scanCache";
+    QDir().mkpath(dir);
+
+    QStringList libs;
+    for (const auto &lib : creator.getLibs()) {
+        const QString copy = dir + "/" + QFileInfo(lib).fileName();
+        QFile::remove(copy);
+        QVERIFY(QFile::copy(lib, copy));
+        libs.push_back(copy);
+    }
+
+    DependenciesScanner scaner;
+
+    ScanCache cache;
+    cache.setCacheFile("./test/scan.cache");
+    cache.invalidate();
+
+    for (const auto &lib : libs) {
+        LibInfo info, cachedInfo;
+
+        QVERIFY(!cache.find(lib, cachedInfo));
+        QVERIFY(scaner.fillLibInfo(info, lib));
+
+        cache.insert(lib, info);
+        QVERIFY(cache.find(lib, cachedInfo));
+
+        QVERIFY(cachedInfo.fullPath() == info.fullPath());
+        QVERIFY(cachedInfo.getPlatform() == info.getPlatform());
+        QVERIFY(cachedInfo.getDependncies() == info.getDependncies());
+    }
+
+    QVERIFY(cache.save());
+
+    ScanCache loadedCache;
+    loadedCache.setCacheFile("./test/scan.cache");
+    QVERIFY(loadedCache.load());
+
+    for (const auto &lib : libs) {
+        LibInfo info;
+        QVERIFY(loadedCache.find(lib, info));
+    }
+
+    QVERIFY(loadedCache.hits() == libs.size());
+
+    QFile changedLib(libs.first());
+    QVERIFY(changedLib.open(QIODevice::Append));
+    changedLib.write("0", 1);
+    changedLib.close();
+
+    LibInfo info;
+    QVERIFY(!loadedCache.find(libs.first(), info));
+
+    // the items of removed files are pruned on save.
+    QVERIFY(QFile::remove(libs.last()));
+    QVERIFY(loadedCache.save());
+
+    ScanCache prunedCache;
+    prunedCache.setCacheFile("./test/scan.cache");
+    QVERIFY(prunedCache.load());
+    QVERIFY(prunedCache.size() == libs.size() - 1);
+
+    QFile::remove("./test/scan.cache");
+    QDir(dir).removeRecursively();
+}
+
+void deploytest::testRpath() {
+    LibInfo lib;
+    lib.setName("libTest.so");
+    lib.setPath("/opt/app/lib");
+    lib.setPlatform(Unix64);
+
+    QVERIFY(ELF::getSearchPaths(lib).isEmpty());
+
+    lib.setRpath("$ORIGIN:${ORIGIN}/../plugins::/opt/Qt/$LIB:$ORIGIN/../lib");
+
+    // the $LIB dirs are not resolved.
+    QStringList expected = {
+        "/opt/app/lib",
+        "/opt/app/plugins"
+    };
+
+    QVERIFY(ELF::getSearchPaths(lib) == expected);
+
+    lib.setPlatform(Unix32);
+    lib.setRpath("/opt/Qt/${LIB}");
+
+    QVERIFY(ELF::getSearchPaths(lib).isEmpty());
+
+    LibCreator creator("./");
+    LibInfo elfLib;
+
+    QVERIFY(ELF().getLibInfo("./linux64", elfLib));
+    QVERIFY(elfLib.getRpath() == "/home/endrii/Qt/5.12.1/gcc_64/lib");
+}
+
+void deploytest::testEnvLibIndex() {
+    QStringList dirs = {
+        QFileInfo("./test/envIndex/a").absoluteFilePath(),
+        QFileInfo("./test/envIndex/b").absoluteFilePath()
+    };
+
+    QStringList files = {
+        dirs[0] + "/libTest.so.1",
+        dirs[1] + "/libTest.so.1",
+        dirs[1] + "/libOther.so",
+        dirs[1] + "/readme.txt"
+    };
+
+    for (const auto &dir: dirs) {
+        QVERIFY(QDir().mkpath(dir));
+    }
+
+    for (const auto &file: files) {
+        QFile f(file);
+        QVERIFY(f.open(QIODevice::WriteOnly));
+        f.close();
+    }
+
+    const QStringList masks = {"*.SO*", "*.so*"};
+
+    EnvLibIndex index;
+    index.build(dirs, masks);
+
+    QVERIFY(index.size() == 3);
+    QVERIFY(index.find("LIBTEST.SO.1") == QStringList({files[0], files[1]}));
+    QVERIFY(index.find("LIBOTHER.SO") == QStringList({files[2]}));
+    QVERIFY(index.find("libOther.so").isEmpty());
+    QVERIFY(index.find("README.TXT").isEmpty());
+    QVERIFY(index.find("LIBNOTEXISTS.SO").isEmpty());
+    QVERIFY(index.mayContain("LIBTEST.SO.1"));
+
+    QVERIFY(index.save("./test/envIndex.index"));
+
+    EnvLibIndex loaded;
+    QVERIFY(loaded.load("./test/envIndex.index", EnvLibIndex::makeFingerprint(dirs)));
+    QVERIFY(loaded.size() == index.size());
+    QVERIFY(loaded.find("LIBTEST.SO.1") == index.find("LIBTEST.SO.1"));
+    QVERIFY(loaded.names() == index.names());
+
+    QVERIFY(!loaded.load("./test/envIndex.index", EnvLibIndex::makeFingerprint({dirs[0]})));
+    QVERIFY(!loaded.size());
+
+    // the order of environment dirs is the order of searching.
+    EnvLibIndex reversed;
+    reversed.build({dirs[1], dirs[0], dirs[1]}, masks);
+
+    QVERIFY(reversed.find("LIBTEST.SO.1") == QStringList({files[1], files[0]}));
+    QVERIFY(EnvLibIndex::makeFingerprint({dirs[1], dirs[0]}) != EnvLibIndex::makeFingerprint(dirs));
+
+    QDir("./test/envIndex").removeRecursively();
+    QFile::remove("./test/envIndex.index");
+}
+
+void deploytest::testLdCache() {
+    struct CacheLib {
+        QByteArray name;
+        QByteArray path;
+        qint32 flags;
+    };
+
+    const QList<CacheLib> libs = {
+        {"libTest.so.1", "/opt/a/libTest.so.1", 0x0303},
+        {"libTest.so.1", "/opt/b/libTest.so.1", 0x0003},
+        {"libOther.so", "/opt/a/libOther.so", 0x0303},
+    };
+
+    auto appendU32 = [](QByteArray& data, quint32 value) {
+        data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    // new format: header, entries and strings, offsets are relative to the header.
+    QByteArray strings;
+    QHash<QByteArray, quint32> offsets;
+    const quint32 stringsBegin = 48 + 24 * static_cast<quint32>(libs.size());
+
+    for (const auto &lib: libs) {
+        for (const auto &str: {lib.name, lib.path}) {
+            if (!offsets.contains(str)) {
+                offsets.insert(str, stringsBegin + static_cast<quint32>(strings.size()));
+                strings.append(str).append('\0');
+            }
+        }
+    }
+
+    QByteArray newCache("glibc-ld.so.cache1.1");
+    appendU32(newCache, static_cast<quint32>(libs.size()));
+    appendU32(newCache, static_cast<quint32>(strings.size()));
+    newCache.append(QByteArray(20, '\0'));
+
+    for (const auto &lib: libs) {
+        appendU32(newCache, static_cast<quint32>(lib.flags));
+        appendU32(newCache, offsets.value(lib.name));
+        appendU32(newCache, offsets.value(lib.path));
+        appendU32(newCache, 0);
+        newCache.append(QByteArray(8, '\0'));
+    }
+
+    newCache.append(strings);
+
+    // old format: offsets are relative to the end of entries.
+    QByteArray oldCache("ld.so-1.7.0");
+    oldCache.append('\0');
+    appendU32(oldCache, static_cast<quint32>(libs.size()));
+
+    for (const auto &lib: libs) {
+        appendU32(oldCache, static_cast<quint32>(lib.flags));
+        appendU32(oldCache, offsets.value(lib.name) - stringsBegin);
+        appendU32(oldCache, offsets.value(lib.path) - stringsBegin);
+    }
+
+    oldCache.append(strings);
+
+    QVERIFY(QDir().mkpath("./test"));
+
+    for (const auto &data: {newCache, oldCache}) {
+        QFile file("./test/ld.so.cache");
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(data);
+        file.close();
+
+        LdCache cache;
+        QVERIFY(cache.load("./test/ld.so.cache"));
+        QVERIFY(cache.size() == libs.size());
+
+        QVERIFY(cache.find("LIBTEST.SO.1") == QStringList({"/opt/a/libTest.so.1", "/opt/b/libTest.so.1"}));
+        QVERIFY(cache.find("LIBTEST.SO.1", Unix64) == QStringList({"/opt/a/libTest.so.1"}));
+        QVERIFY(cache.find("LIBTEST.SO.1", Unix32) == QStringList({"/opt/b/libTest.so.1"}));
+        QVERIFY(cache.find("LIBTEST.SO.1", Win64).isEmpty());
+        QVERIFY(cache.find("LIBNOTEXISTS.SO").isEmpty());
+
+        cache.removeDir("/opt/a");
+        QVERIFY(cache.find("LIBOTHER.SO").isEmpty());
+        QVERIFY(cache.dirs() == QStringList({"/opt/b"}));
+    }
+
+    QFile file("./test/ld.so.cache");
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(newCache.left(60));
+    file.close();
+
+    LdCache broken;
+    QVERIFY(!broken.load("./test/ld.so.cache"));
+    QVERIFY(!broken.isValid());
+
+    QFile::remove("./test/ld.so.cache");
+}
+
+void deploytest::testScanMany() {
+    LibCreator creator("./");
+
+    QString envDir = QFileInfo("./test/scanMany").absoluteFilePath();
+    QString qtCore = envDir + "/libQt5Core.so.5";
+
+    QVERIFY(QDir().mkpath(envDir));
+    QFile::remove(qtCore);
+    QVERIFY(QFile::copy("./linux64.so", qtCore));
+
+    DependenciesScanner scaner;
+    scaner.setEnvironment({envDir});
+
+    QString app = QFileInfo("./linux64").absoluteFilePath();
+    QString lib = QFileInfo("./linux64.so").absoluteFilePath();
+    QString notExists = QFileInfo("./notExists.so").absoluteFilePath();
+
+    auto result = scaner.scanMany({app, lib, app, notExists});
+
+    QVERIFY(result.roots() == QStringList({app, lib, notExists}));
+    QVERIFY(result.libs().size() == 1);
+    QVERIFY(result.libs().first().fullPath() == qtCore);
+
+    QVERIFY(result.closure(app) == QVector<int>{0});
+    QVERIFY(result.closure(lib) == QVector<int>{0});
+    QVERIFY(result.closure(notExists).isEmpty());
+
+    QVERIFY(result.closureSet(app) == scaner.scan(app));
+
+    QDir(envDir).removeRecursively();
+}
+
+void deploytest::testDependencyGraph() {
+    DependencyGraph graph;
+
+    auto addNode = [&graph](const QString& name) {
+        LibInfo info;
+        info.setName(name);
+        info.setPath("/test");
+        info.setPlatform(Unix64);
+        return graph.addNode(info);
+    };
+
+    int app = addNode("app");
+    int core = addNode("libCore.so");
+    int gui = addNode("libGui.so");
+    int cycle = addNode("libCycle.so");
+
+    QVERIFY(addNode("libCore.so") == core);
+    QVERIFY(graph.find("/test/libGui.so") == gui);
+    QVERIFY(graph.find("/test/libNotExists.so") == -1);
+    QVERIFY(!graph.isResolved(app));
+
+    graph.setEdges(app, {gui});
+    graph.setEdges(gui, {core, cycle});
+    graph.setEdges(core, {});
+    graph.setEdges(cycle, {gui});
+
+    QVERIFY(graph.isResolved(app));
+    QVERIFY(graph.closure(core).isEmpty());
+    QVERIFY(graph.closure(gui) == QVector<int>({core, cycle}));
+    QVERIFY(graph.closure(cycle) == QVector<int>({core, gui}));
+    QVERIFY(graph.closure(app) == QVector<int>({core, gui, cycle}));
+
+    int plugin = addNode("libPlugin.so");
+    graph.setClosure(plugin, {core, plugin, core}, WinAPI::NoWinAPI);
+    QVERIFY(graph.hasClosure(plugin));
+    QVERIFY(graph.closure(plugin) == QVector<int>({core}));
+}
+
+void deploytest::testMappedPe() {
+    LibCreator creator("./");
+    auto deps = creator.getLibsDep();
+    auto platforms = creator.getLibplatform();
+
+    for (const auto &lib : creator.getLibs()) {
+        MappedPe pe(lib);
+
+        if (platforms.value(lib) & Platform::Unix) {
+            QVERIFY(!pe.open());
+            continue;
+        }
+
+        QVERIFY(pe.open());
+        QVERIFY(pe.readImports());
+
+        QVERIFY((pe.magic() == MappedPe::MagicPE32) == (platforms.value(lib) == Platform::Win32));
+
+        QSet<QString> imports;
+        for (const char* module : pe.imports()) {
+            imports.insert(QString::fromLatin1(module).toUpper());
+        }
+
+        for (const auto &dep : deps.value(lib)) {
+            QVERIFY(imports.contains(dep.toUpper()));
+        }
+    }
+}
+
+void deploytest::testProbePlatform() {
+    LibCreator creator("./");
+    auto platforms = creator.getLibplatform();
+
+    DependenciesScanner scaner;
+
+    for (const auto &lib : creator.getLibs()) {
+        QVERIFY(scaner.probePlatform(lib) == platforms.value(lib));
+        QVERIFY(scaner.isAcceptable(lib, platforms.value(lib)));
+    }
+
+    QVERIFY(scaner.probePlatform("./notExistsLib.so") == UnknownPlatform);
+
+    QStringList candidates = {"./win32mingw.dll", "./win64mingw.dll"};
+    LibInfo info;
+    QVERIFY(scaner.selectCandidate(candidates, "mingw.dll", Platform::Win64, info));
+    QVERIFY(info.getName() == "win64mingw.dll");
+    QVERIFY(!scaner.selectCandidate(candidates, "mingw.dll", Platform::Unix64, info));
+}
+
+void deploytest::testParallelCopy() {
+    LibCreator creator("./");
+    const QString target = "./test/parallelCopy";
+
+    FileManager manager;
+
+    for (const auto &lib : creator.getLibs()) {
+        QVERIFY(manager.copyFile(lib, target));
+        // the second copy of the same file is skipped.
+        QVERIFY(manager.copyFile(lib, target));
+    }
+
+    QVERIFY(manager.waitForCopies());
+
+    auto deployed = manager.getDeployedFiles();
+
+    for (const auto &lib : creator.getLibs()) {
+        QFileInfo copied(target + "/" + QFileInfo(lib).fileName());
+
+        QVERIFY(copied.exists());
+        QVERIFY(copied.size() == QFileInfo(lib).size());
+        QVERIFY(deployed.contains(copied.absoluteFilePath()));
+    }
+
+    QDir(target).removeRecursively();
+}
+
+void deploytest::testFileCopier() {
+#ifdef Q_OS_UNIX
+    LibCreator creator("./");
+    const QString source = "./linux64";
+    const QString target = "./linux64.copy";
+    const QString link = "./linux64.link";
+
+    QFile::remove(target);
+    QFile::remove(link);
+
+    quint64 hash = 0;
+    QVERIFY(FileCopier::copy(source, target, false, &hash) != CopyMethod::NotCopied);
+    QVERIFY(hash && hash == DeployManifest::contentHash(source));
+    QVERIFY(FileCopier::copy(source, target) == CopyMethod::NotCopied);
+
+    QFile sourceFile(source);
+    QFile targetFile(target);
+    QVERIFY(sourceFile.open(QIODevice::ReadOnly));
+    QVERIFY(targetFile.open(QIODevice::ReadOnly));
+    QVERIFY(sourceFile.readAll() == targetFile.readAll());
+    QVERIFY(sourceFile.permissions() == targetFile.permissions());
+
+    QVERIFY(FileCopier::linksCount(target) == 1);
+    QVERIFY(FileCopier::copy(target, link, true) == CopyMethod::Hardlink);
+    QVERIFY(FileCopier::linksCount(target) == 2);
+
+    QFile::remove(target);
+    QFile::remove(link);
+#endif
+}
+
+void deploytest::testIncrementalCompare() {
+    LibCreator creator("./");
+    const QString source = "./linux64";
+    const QString target = "./linux64.incremental";
+
+    QFile::remove(target);
+    QVERIFY(FileCopier::compare(source, target) == TargetState::NotExists);
+
+    QVERIFY(QFile::copy(source, target));
+    QVERIFY(FileCopier::copyModificationTime(source, target));
+    QVERIFY(FileCopier::compare(source, target) == TargetState::Same);
+
+    // the source is compared with the record of copy.
+    DeployManifestItem deployed;
+    deployed.hasSource = true;
+    deployed.sourceSize = QFileInfo(source).size();
+    deployed.sourceMtime = QFileInfo(source).lastModified().toMSecsSinceEpoch();
+    QVERIFY(FileCopier::compare(source, target, &deployed) == TargetState::Same);
+
+    deployed.sourceSize++;
+    QVERIFY(FileCopier::compare(source, target, &deployed) == TargetState::SameSize);
+    deployed.sourceSize--;
+
+    QFile targetFile(target);
+    QVERIFY(targetFile.open(QIODevice::Append));
+    QVERIFY(targetFile.setFileTime(QDateTime::currentDateTime().addDays(-1),
+                                   QFileDevice::FileModificationTime));
+    targetFile.close();
+
+    QVERIFY(FileCopier::compare(source, target) == TargetState::SameSize);
+    QVERIFY(FileCopier::sameContent(source, target));
+
+    QVERIFY(targetFile.open(QIODevice::Append));
+    targetFile.write("changed");
+    targetFile.close();
+
+    QVERIFY(FileCopier::compare(source, target) == TargetState::Changed);
+    QVERIFY(!FileCopier::sameContent(source, target));
+
+    // the stripped target has other size, so it is not changed only if the source is same as recorded.
+    QVERIFY(FileCopier::copyModificationTime(source, target));
+    QVERIFY(FileCopier::compare(source, target) == TargetState::Changed);
+    QVERIFY(FileCopier::compare(source, target, &deployed) == TargetState::Same);
+
+    // the target that is changed after deploy is not same as recorded.
+    deployed.hasInfo = true;
+    deployed.size = QFileInfo(target).size() - 1;
+    deployed.mtime = QFileInfo(target).lastModified().toMSecsSinceEpoch();
+    QVERIFY(FileCopier::compare(source, target, &deployed) == TargetState::Changed);
+
+    deployed.size++;
+    QVERIFY(FileCopier::compare(source, target, &deployed) == TargetState::Same);
+
+    QFile::remove(target);
+}
+
+void deploytest::testStripDeployed() {
+#ifdef Q_OS_UNIX
+    const QString source = "./test/stripSource/debugLib.so";
+    const QString target = "./test/stripTarget";
+
+    qint64 sizeBefor = generateLib(source);
+
+    // the moved library is not stripped while transferring, so it is stripped by the stripDeployed.
+    FileManager manager;
+    QVERIFY(manager.moveFile(source, target));
+
+    QFileInfo stripped(target + "/debugLib.so");
+    QVERIFY(stripped.size() == sizeBefor);
+
+    QVERIFY(manager.stripDeployed());
+
+    stripped.refresh();
+    QVERIFY(stripped.size() < sizeBefor);
+
+    // the library is stripped only once.
+    auto modified = stripped.lastModified();
+    QVERIFY(manager.stripDeployed());
+    stripped.refresh();
+    QVERIFY(stripped.lastModified() == modified);
+
+    // the copied library is stripped while copying and is not added to the stripDeployed.
+    generateLib(source);
+    QVERIFY(manager.copyFile(source, target + "/copy"));
+    QVERIFY(manager.waitForCopies());
+
+    QFileInfo copied(target + "/copy/debugLib.so");
+    QVERIFY(copied.size() < sizeBefor);
+
+    modified = copied.lastModified();
+    QVERIFY(manager.stripDeployed());
+    copied.refresh();
+    QVERIFY(copied.lastModified() == modified);
+
+    QDir("./test/stripSource").removeRecursively();
+    QDir(target).removeRecursively();
+#endif
+}
+
+void deploytest::testElfStrip() {
+    const QString source = "./test/elfStrip/debugLib.so";
+    const QString target = "./test/elfStrip/strippedLib.so";
+
+    qint64 sizeBefor = generateLib(source);
+
+    quint64 hash = 0;
+    QVERIFY(ElfStrip::copyStripped(source, target, QString(), &hash));
+    QVERIFY(QFileInfo(target).size() < sizeBefor);
+    QVERIFY(hash && hash == DeployManifest::contentHash(target));
+
+    MappedElf sourceElf(source);
+    MappedElf targetElf(target);
+
+    QVERIFY(sourceElf.open() && sourceElf.readSections() && sourceElf.readDynamic());
+    QVERIFY(targetElf.open() && targetElf.readSections() && targetElf.readDynamic());
+
+    QVERIFY(targetElf.needed().size() == sourceElf.needed().size());
+    QVERIFY(QByteArray(targetElf.soname()) == QByteArray(sourceElf.soname()));
+
+    for (int i = 0; i < targetElf.sections().size(); ++i) {
+        QVERIFY(!ElfStrip::isStripSection(targetElf.sectionName(i)));
+    }
+
+    // the file is replaced by the stripped copy in place, the not supported file is kept.
+    const QString inPlace = "./test/elfStrip/inPlaceLib.so";
+    QVERIFY(QFile::copy(source, inPlace));
+    QVERIFY(ElfStrip::strip(inPlace, QString(), &hash));
+    QVERIFY(QFileInfo(inPlace).size() == QFileInfo(target).size());
+    QVERIFY(hash == DeployManifest::contentHash(inPlace));
+    QVERIFY(!QFile::exists(inPlace + ".strip"));
+
+    QVERIFY(QFile::copy(":/win64mingw.dll", inPlace + ".pe"));
+    QVERIFY(!ElfStrip::strip(inPlace + ".pe"));
+    QVERIFY(QFile::exists(inPlace + ".pe") && !QFile::exists(inPlace + ".pe.strip"));
+
+    // the existing target is not replaced (the noOverwrite option).
+    QFile existing(target + ".old");
+    QVERIFY(existing.open(QIODevice::WriteOnly) && existing.write("old") == 3);
+    existing.close();
+
+    QVERIFY(!ElfStrip::copyStripped(source, existing.fileName()));
+    QVERIFY(existing.open(QIODevice::ReadOnly) && existing.readAll() == "old");
+    existing.close();
+
+    // not ELF files are not supported
+    QVERIFY(!ElfStrip::copyStripped(":/win64mingw.dll", target + ".pe"));
+
+    // the offset of program headers near the max value does not overflow the bounds check.
+    if (sourceElf.elfClass() == MappedElf::ElfClass64) {
+        const QString brokenLib = "./test/elfStrip/brokenLib.so";
+        QVERIFY(QFile::copy(source, brokenLib));
+
+        QFile brokenFile(brokenLib);
+        QVERIFY(brokenFile.open(QIODevice::ReadWrite) && brokenFile.seek(32));
+        QVERIFY(brokenFile.write(QByteArray(8, '\xff')) == 8);
+        brokenFile.close();
+
+        MappedElf broken(brokenLib);
+        QVERIFY(!broken.open());
+
+        // the offset of section near the max value does not overflow the bounds checks of strip.
+        QVERIFY(QFile::remove(brokenLib) && QFile::copy(source, brokenLib));
+        QVERIFY(brokenFile.open(QIODevice::ReadWrite));
+
+        const auto header = brokenFile.read(64);
+        const quint64 sectionsOffset = qFromLittleEndian<quint64>(header.constData() + 40);
+        const quint16 namesIndex = qFromLittleEndian<quint16>(header.constData() + 62);
+
+        QVERIFY(brokenFile.seek(static_cast<qint64>(sectionsOffset) + namesIndex * 64 + 24));
+        QVERIFY(brokenFile.write(QByteArray(8, '\xff')) == 8);
+        brokenFile.close();
+
+        QVERIFY(!ElfStrip::copyStripped(brokenLib, target + ".broken"));
+        QVERIFY(!QFile::exists(target + ".broken"));
+    }
+
+    QDir("./test/elfStrip").removeRecursively();
+}
+
+void deploytest::testSplitDebug() {
+    const QString source = "./test/splitDebug/debugLib.so";
+    const QString target = "./test/splitDebug/strippedLib.so";
+    const QString debug = "./test/splitDebug/symbols/strippedLib.so.debug";
+
+    generateLib(source);
+    QDir().mkpath("./test/splitDebug/symbols");
+
+    QVERIFY(ElfStrip::copyStripped(source, target, debug));
+
+    MappedElf targetElf(target);
+    MappedElf debugElf(debug);
+
+    QVERIFY(targetElf.open() && targetElf.readSections() && targetElf.readDynamic());
+    QVERIFY(debugElf.open() && debugElf.readSections());
+
+    int linkIndex = -1;
+    for (int i = 0; i < targetElf.sections().size(); ++i) {
+        QVERIFY(!ElfStrip::isStripSection(targetElf.sectionName(i)));
+
+        if (targetElf.sectionName(i) == ".gnu_debuglink") {
+            linkIndex = i;
+        }
+    }
+
+    QVERIFY(linkIndex > 0);
+
+    // the debug file keeps the removed sections.
+    bool hasSymbols = false;
+    for (int i = 0; i < debugElf.sections().size(); ++i) {
+        hasSymbols = hasSymbols || debugElf.sectionName(i) == ".symtab";
+    }
+
+    QVERIFY(hasSymbols);
+
+    // the link contains name of the debug file and the checksum of it.
+    const auto &link = targetElf.sections()[linkIndex];
+    QByteArray linkData(reinterpret_cast<const char*>(targetElf.data() + link.offset),
+                        static_cast<int>(link.size));
+
+    QVERIFY(linkData.startsWith("strippedLib.so.debug"));
+
+    QFile debugFile(debug);
+    QVERIFY(debugFile.open(QIODevice::ReadOnly));
+    auto debugData = debugFile.readAll();
+
+    quint32 crc = ElfStrip::crc32(debugData.constData(), static_cast<quint64>(debugData.size()));
+    QVERIFY(qFromLittleEndian<quint32>(linkData.constData() + linkData.size() - 4) == crc);
+
+    QDir("./test/splitDebug").removeRecursively();
+}
+
+void deploytest::testDeployManifest() {
+    const QString dir = QFileInfo("./test/manifest").absoluteFilePath();
+    const QString manifestFile = dir + "/target.manifest";
+    const QString file = dir + "/lib.so";
+    const QString source = dir + "/source/lib.so";
+
+    QDir().mkpath(dir);
+    generateLib(file);
+    generateLib(source);
+
+    // the manifest is not saved in the cache dir, that can be cleared.
+    QVERIFY(!DeployManifest::manifestFile(dir).startsWith(DeployCore::getCacheDir()));
+
+    DeployManifest manifest;
+    manifest.setManifestFile(manifestFile);
+
+    QVERIFY(!manifest.load());
+    QVERIFY(manifest.append(file));
+    QVERIFY(manifest.append(dir + "/notExists"));
+    QVERIFY(manifest.append(file));
+
+    // the appended records are readable without save.
+    QVERIFY(manifest.load());
+    QVERIFY(manifest.size() == 2);
+
+    DeployManifestItem item;
+    QVERIFY(manifest.find(file, item));
+    QVERIFY(!item.hasInfo);
+
+    // the source and the hash of copy are recorded while appending, the last record of path is saved.
+    QVERIFY(manifest.append(file, source, DeployManifest::contentHash(file)));
+    QVERIFY(!manifest.updateHash(dir + "/notDeployed", 1));
+    QVERIFY(manifest.save({file, dir + "/notExists"}));
+    QVERIFY(manifest.find(file, item));
+    QVERIFY(item.hasInfo && item.hasSource);
+    QVERIFY(item.size == QFileInfo(file).size());
+    QVERIFY(item.mtime == QFileInfo(file).lastModified().toMSecsSinceEpoch());
+    QVERIFY(item.hash == DeployManifest::contentHash(file));
+    QVERIFY(item.sourceSize == QFileInfo(source).size());
+    QVERIFY(item.sourceMtime == QFileInfo(source).lastModified().toMSecsSinceEpoch());
+
+    // the file that is not copied again keeps the record of the previous deploy.
+    QVERIFY(manifest.save({file, dir + "/notExists"}));
+    QVERIFY(manifest.find(file, item));
+    QVERIFY(item.hasInfo && item.hash == DeployManifest::contentHash(file));
+
+    // the changed content replaces the hash.
+    QVERIFY(manifest.updateHash(file, 0));
+    QVERIFY(manifest.find(file, item));
+    QVERIFY(!item.hash && item.hasSource);
+    QVERIFY(manifest.save({file, dir + "/notExists"}));
+
+    QVERIFY(manifest.find(dir + "/notExists", item));
+    QVERIFY(!item.hasInfo);
+
+    // the broken tail of the interrupted write is ignored.
+    manifest.setManifestFile(manifestFile);
+    {
+        QFile broken(manifestFile);
+        QVERIFY(broken.open(QIODevice::Append));
+        broken.write("broken");
+    }
+
+    QVERIFY(manifest.load());
+    QVERIFY(manifest.size() == 2);
+    QVERIFY(manifest.append(dir + "/newFile"));
+    QVERIFY(manifest.load());
+    QVERIFY(manifest.size() == 3);
+    QVERIFY(manifest.paths().contains(dir + "/newFile"));
+
+    manifest.setManifestFile("");
+    QDir(dir).removeRecursively();
+}
+
+void deploytest::testClear() {
+    LibCreator creator("./");
+    const QString target = QFileInfo("./test/clear").absoluteFilePath();
+    const QStringList dirs = {"/sub0/deep", "/sub1/deep", "/sub2/deep"};
+
+    FileManager manager;
+
+    for (const auto &dir : dirs) {
+        for (const auto &lib : creator.getLibs()) {
+            QVERIFY(manager.copyFile(lib, target + dir));
+        }
+    }
+
+    QVERIFY(manager.waitForCopies());
+
+    // the not deployed file is not removed with its dir.
+    const QString userFile = target + "/sub0/deep/user.txt";
+    {
+        QFile file(userFile);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("user data");
+    }
+
+    auto result = manager.clear(target, false);
+
+    QVERIFY(result.removedFiles == creator.getLibs().size() * dirs.size());
+    QVERIFY(result.removedDirs == dirs.size() - 1);
+    QVERIFY(!result.failed);
+    QVERIFY(manager.getDeployedFiles().isEmpty());
+
+    QVERIFY(QFileInfo::exists(userFile));
+    QVERIFY(!QFileInfo::exists(target + "/sub1/deep"));
+
+    result = manager.clear(target, true);
+
+    QVERIFY(result.removedFiles == 1);
+    QVERIFY(!result.failed);
+    QVERIFY(!QFileInfo::exists(target));
+}
+
+void deploytest::testKeepSymlinks() {
+#ifdef Q_OS_UNIX
+    const QString source = QFileInfo("./test/symlinks/source").absoluteFilePath();
+    const QString target = QFileInfo("./test/symlinks/target").absoluteFilePath();
+    const QString real = source + "/libTest.so.5.14.2";
+
+    QDir().mkpath(source);
+    generateLib(real);
+    QVERIFY(QFile::link("libTest.so.5.14.2", source + "/libTest.so.5"));
+    QVERIFY(QFile::link("libTest.so.5", source + "/libTest.so"));
+
+    // all names of one library are parsed once.
+    DependenciesScanner scaner;
+    LibInfo realInfo, linkInfo;
+
+    QVERIFY(scaner.fillLibInfo(realInfo, real));
+    QVERIFY(scaner.fillLibInfo(linkInfo, source + "/libTest.so"));
+    QVERIFY(scaner._parsedIds.size() == 1);
+    QVERIFY(linkInfo.getName() == "libTest.so");
+    QVERIFY(linkInfo.getDependncies() == realInfo.getDependncies());
+
+    QuasarAppUtils::Params::parseParams(QStringList{"keepSymlinks", "noStrip"});
+
+    FileManager manager;
+    QVERIFY(manager.copyFile(source + "/libTest.so", target));
+    QVERIFY(manager.waitForCopies());
+
+    QVERIFY(QFileInfo(target + "/libTest.so").isSymLink());
+    QVERIFY(QFileInfo(target + "/libTest.so.5").isSymLink());
+    QVERIFY(!QFileInfo(target + "/libTest.so.5.14.2").isSymLink());
+    QVERIFY(QFileInfo(target + "/libTest.so").size() == QFileInfo(real).size());
+
+    auto deployed = manager.getDeployedFiles();
+    QVERIFY(deployed.contains(target + "/libTest.so"));
+    QVERIFY(deployed.contains(target + "/libTest.so.5"));
+    QVERIFY(deployed.contains(target + "/libTest.so.5.14.2"));
+
+    QuasarAppUtils::Params::parseParams(QStringList{});
+    QDir("./test/symlinks").removeRecursively();
+#endif
+}
+
+void deploytest::testDedup() {
+#ifdef Q_OS_UNIX
+    const QString source = "./linux64";
+    const QString target = QFileInfo("./test/dedup").absoluteFilePath();
+    const QStringList packages = {"/package1", "/package2", "/package3"};
+
+    LibCreator creator("./");
+
+    QuasarAppUtils::Params::parseParams(QStringList{"-dedup", "hardlink"});
+
+    {
+        FileManager manager;
+
+        for (const auto &package : packages) {
+            QVERIFY(manager.copyFile(source, target + package));
+        }
+
+        QVERIFY(manager.waitForCopies());
+
+        for (const auto &package : packages) {
+            QVERIFY(FileCopier::linksCount(target + package + "/linux64") == packages.size());
+            QVERIFY(manager.getDeployedFiles().contains(target + package + "/linux64"));
+        }
+    }
+
+    QDir(target).removeRecursively();
+    QuasarAppUtils::Params::parseParams(QStringList{"-dedup", "symlink"});
+
+    {
+        FileManager manager;
+
+        for (const auto &package : packages) {
+            QVERIFY(manager.copyFile(source, target + package));
+        }
+
+        QVERIFY(manager.waitForCopies());
+
+        int links = 0;
+        for (const auto &package : packages) {
+            QFileInfo copied(target + package + "/linux64");
+
+            QVERIFY(copied.size() == QFileInfo(source).size());
+            links += copied.isSymLink();
+        }
+
+        QVERIFY(links == packages.size() - 1);
+    }
+
+    QuasarAppUtils::Params::parseParams(QStringList{});
+    QDir(target).removeRecursively();
+#endif
+}
+
+void deploytest::testQmlImportParser() {
+    const QByteArray qml =
+            "/* import Commented 1.0\n"
+            "   import Commented.Block 1.0 */\n"
+            "pragma Singleton\n"
+            "import QtQuick 2.15; import QtQuick.Controls 2.15 as QQC2 // import Commented 1.0\n"
+            "import \"js/utils.js\" as Utils\n"
+            "import \"./components\"\n"
+            "import QtQuick.Window\n"
+            "import   QtQuick.Layouts   1.3\n"
+            "QQC2.ApplicationWindow {\n"
+            "    property string text: \"import InString 1.0\"\n"
+            "}\n"
+            "import AfterObject 1.0\n";
+
+    auto imports = QmlImportParser::parse(qml);
+
+    QVERIFY(imports == QStringList({"2#QtQuick",
+                                    "2#QtQuick/Controls",
+                                    "#QtQuick/Window",
+                                    "1#QtQuick/Layouts"}));
+
+    // the result of file is cached while file is not changed.
+    const QString file = "./test/qmlParser/main.qml";
+    QDir().mkpath("./test/qmlParser");
+
+    {
+        QFile source(file);
+        QVERIFY(source.open(QIODevice::WriteOnly));
+        source.write(qml);
+    }
+
+    QVERIFY(QmlImportParser::importsOfFile(file) == imports);
+    QVERIFY(QmlImportParser::importsOfFile(file) == imports);
+
+    QmlImportParser::clearCache();
+    QDir("./test/qmlParser").removeRecursively();
+}
+
+void deploytest::testQmlModuleIndex() {
+    const QString root = QFileInfo("./test/qmlIndex/qml").absoluteFilePath();
+
+    auto writeQmldir = [&root](const QString& dir, const QByteArray& content) {
+        QDir().mkpath(root + "/" + dir);
+        QFile qmldir(root + "/" + dir + "/qmldir");
+        QVERIFY(qmldir.open(QIODevice::WriteOnly));
+        qmldir.write(content);
+    };
+
+    writeQmldir("QtQml", "module QtQml\nplugin qmlplugin\n");
+    writeQmldir("QtQuick.2", "module QtQuick\nplugin qtquick2plugin\nimport QtQml 2.0\n");
+    writeQmldir("QtQuick/Layouts", "module QtQuick.Layouts\nplugin qquicklayoutsplugin\n");
+    writeQmldir("QtQuick/Templates.2", "module QtQuick.Templates\n");
+    writeQmldir("QtQuick/Controls.2",
+                "# comment\n"
+                "module QtQuick.Controls\n"
+                "plugin qtquickcontrols2plugin\n"
+                "depends QtQuick.Templates 2.5\n"
+                "import QtQuick.Controls.impl auto\n");
+    writeQmldir("QtQuick/Controls.2/impl", "module QtQuick.Controls.impl\n");
+
+    QmlModuleIndex index;
+    index.build(root);
+
+    QVERIFY(index.size() == 6);
+
+    auto quick = index.find("2#QtQuick");
+    QVERIFY(quick && quick->path == root + "/QtQuick.2");
+    QVERIFY(quick->plugins == QStringList{"qtquick2plugin"});
+
+    QVERIFY(index.find("1#QtQuick/Layouts")->path == root + "/QtQuick/Layouts");
+    QVERIFY(index.find("#QtQuick/Controls")->path == root + "/QtQuick/Controls.2");
+    QVERIFY(!index.find("2#QtQuick/NotExists"));
+
+    auto modules = index.resolve({"2#QtQuick/Controls"});
+    modules.sort();
+
+    QVERIFY(modules == QStringList({root + "/QtQuick/Controls.2",
+                                    root + "/QtQuick/Controls.2/impl",
+                                    root + "/QtQuick/Templates.2"}));
+
+    // the scaner follows the depends of modules.
+    QDir().mkpath("./test/qmlIndex/src");
+    {
+        QFile source("./test/qmlIndex/src/main.qml");
+        QVERIFY(source.open(QIODevice::WriteOnly));
+        source.write("import QtQuick 2.15\nItem {}\n");
+    }
+
+    QStringList paths;
+    QML scaner(root, &index);
+    QVERIFY(scaner.scan(paths, "./test/qmlIndex/src"));
+    paths.sort();
+
+    QVERIFY(paths == QStringList({root + "/QtQml", root + "/QtQuick.2"}));
+
+    // the cached index is valid while the qml dir is not changed.
+    const QString file = "./test/qmlIndex/modules.index";
+    QVERIFY(index.save(file));
+
+    QmlModuleIndex loaded;
+    QVERIFY(loaded.load(file, QmlModuleIndex::makeFingerprint(root)));
+    QVERIFY(loaded.size() == index.size());
+    QVERIFY(loaded.find("2#QtQuick/Controls")->depends ==
+            QStringList({"2#QtQuick/Templates", "2#QtQuick/Controls/impl"}));
+
+    QVERIFY(!loaded.load(file, QByteArray("other")));
+
+    QmlImportParser::clearCache();
+    QDir("./test/qmlIndex").removeRecursively();
+}
+
+void deploytest::testPeakMemoryUsage() {
+#ifdef Q_OS_LINUX
+    auto peak = DeployCore::peakMemoryUsage();
+    QVERIFY(peak > 0);
+
+    // the peak value is not decreased after the memory is freed.
+    {
+        QByteArray data(16 * 1024 * 1024, 1);
+        QVERIFY(data.at(data.size() - 1) == 1);
+    }
+
+    QVERIFY(DeployCore::peakMemoryUsage() >= peak);
+#endif
+}
+
+void deploytest::testPathMatcher() {
+    PathMatcher matcher(QStringList{"he", "she", "hers", "his"});
+    QVector<int> ids;
+
+    QVERIFY(matcher.match("/usr/lib/ushers", &ids));
+    QVERIFY(ids == QVector<int>({0, 1, 2}));
+    QVERIFY(matcher.find("/opt/this") == 3);
+    QVERIFY(!matcher.match("/usr/lib/HERS"));
+    QVERIFY(matcher.find("/usr/lib/libQt5Core.so") == -1);
+
+    // the case of patterns is folded once.
+    PathMatcher insensitive(Qt::CaseInsensitive);
+    QVERIFY(insensitive.addPattern("libQt5") == 0);
+    QVERIFY(insensitive.addPattern("/usr/LIB", true) == 1);
+
+    QVERIFY(insensitive.match("/USR/lib/LIBQT5Core.so", &ids));
+    QVERIFY(ids == QVector<int>({0, 1}));
+
+    // the prefix pattern matches only the begin of path.
+    QVERIFY(insensitive.match("/opt/usr/lib/libqt5Gui.so", &ids));
+    QVERIFY(ids == QVector<int>({0}));
+    QVERIFY(!insensitive.match("/opt/usr/lib/libz.so"));
+
+    // the empty pattern matches any path like QString::contains.
+    QVERIFY(insensitive.addPattern("") == 2);
+    QVERIFY(insensitive.find("/opt/libz.so") == 2);
+
+    insensitive.clear();
+    QVERIFY(insensitive.isEmpty());
+    QVERIFY(!insensitive.match("/usr/lib/libqt5Core.so"));
+
+    // the copy of not compiled matcher is compiled separately.
+    insensitive.addPatterns({"qt5core", "QT5GUI"});
+    PathMatcher copy = insensitive;
+    QVERIFY(copy.find("/usr/lib/libQt5Gui.so") == 1);
+    QVERIFY(insensitive.find("/usr/lib/libqt5Core.so") == 0);
+
+    // the ignore rules are checked only if the label is in path.
+    IgnoreRule rules;
+    IgnoreData rule("libfoo");
+    rule.platform = Unix64;
+    rules.addRule(rule);
+    rules.addRule(IgnoreData("LIBBAR"));
+
+    LibInfo info;
+    info.setPath("/opt/lib");
+    info.setName("libfoo.so");
+    info.setPlatform(Unix32);
+
+    QVERIFY(!rules.isIgnore(info));
+
+    info.setPlatform(Unix64);
+    QVERIFY(rules.isIgnore(info) && rules.isIgnore(info)->label == "libfoo");
+
+    info.setName("libbar.so");
+    QVERIFY(rules.isIgnore(info) && rules.isIgnore(info)->label == "LIBBAR");
+
+    info.setName("libbaz.so");
+    QVERIFY(!rules.isIgnore(info));
+}
+
 void deploytest::testQmlExtrct() {
     QmlCreator creator("./");
     auto imports = creator.getQmlImports();